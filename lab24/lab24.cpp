@@ -1,20 +1,242 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
 #include <functional>
+#include <iomanip>
 #include <iostream>
-#include <sstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define LAB24_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+class NumericKernels
+{
+private:
+#ifdef LAB24_X86_SIMD
+    static bool HasAvx()
+    {
+        static const bool supported = __builtin_cpu_supports("avx");
+        return supported;
+    }
+
+    __attribute__((target("avx")))
+    static size_t SquareAvx(const double* input, double* output, size_t size)
+    {
+        size_t i = 0;
+        for (; i + 4 <= size; i += 4)
+        {
+            const __m256d value = _mm256_loadu_pd(input + i);
+            _mm256_storeu_pd(output + i, _mm256_mul_pd(value, value));
+        }
+
+        return i;
+    }
+
+    __attribute__((target("avx")))
+    static size_t CubeAvx(const double* input, double* output, size_t size)
+    {
+        size_t i = 0;
+        for (; i + 4 <= size; i += 4)
+        {
+            const __m256d value = _mm256_loadu_pd(input + i);
+            _mm256_storeu_pd(output + i, _mm256_mul_pd(_mm256_mul_pd(value, value), value));
+        }
+
+        return i;
+    }
+
+    __attribute__((target("avx")))
+    static size_t CountNegativeAvx(const double* input, size_t size, size_t& negatives)
+    {
+        const __m256d zero = _mm256_setzero_pd();
+        __m256d anyNegative = zero;
+        size_t i = 0;
+        for (; i + 4 <= size; i += 4)
+        {
+            anyNegative = _mm256_or_pd(anyNegative, _mm256_cmp_pd(_mm256_loadu_pd(input + i), zero, _CMP_LT_OQ));
+        }
+
+        negatives = static_cast<size_t>(_mm256_movemask_pd(anyNegative));
+        return i;
+    }
+
+    __attribute__((target("avx")))
+    static size_t SquareRootAvx(const double* input, double* output, size_t size)
+    {
+        size_t i = 0;
+        for (; i + 4 <= size; i += 4)
+        {
+            _mm256_storeu_pd(output + i, _mm256_sqrt_pd(_mm256_loadu_pd(input + i)));
+        }
+
+        return i;
+    }
+
+    __attribute__((target("avx")))
+    static size_t SelectCandidatesAvx(const double* values, size_t size, double quietLow, double quietHigh,
+                                      double hotLow, double hotHigh, std::uint32_t* indices, size_t& selected)
+    {
+        const __m256d quietLowVector = _mm256_set1_pd(quietLow);
+        const __m256d quietHighVector = _mm256_set1_pd(quietHigh);
+        const __m256d hotLowVector = _mm256_set1_pd(hotLow);
+        const __m256d hotHighVector = _mm256_set1_pd(hotHigh);
+
+        size_t i = 0;
+        for (; i + 4 <= size; i += 4)
+        {
+            const __m256d value = _mm256_loadu_pd(values + i);
+            const __m256d quiet = _mm256_and_pd(_mm256_cmp_pd(quietLowVector, value, _CMP_LE_OQ),
+                                                _mm256_cmp_pd(value, quietHighVector, _CMP_LE_OQ));
+            const __m256d hot = _mm256_and_pd(_mm256_cmp_pd(hotLowVector, value, _CMP_LE_OQ),
+                                              _mm256_cmp_pd(value, hotHighVector, _CMP_LE_OQ));
+
+            unsigned int mask = (~static_cast<unsigned int>(_mm256_movemask_pd(quiet)) |
+                                 static_cast<unsigned int>(_mm256_movemask_pd(hot))) & 0xF;
+            while (mask != 0)
+            {
+                indices[selected++] = static_cast<std::uint32_t>(i + static_cast<size_t>(__builtin_ctz(mask)));
+                mask &= mask - 1;
+            }
+        }
+
+        return i;
+    }
+#endif
+
+public:
+    static void Square(const double* input, double* output, size_t size)
+    {
+        size_t i = 0;
+#ifdef LAB24_X86_SIMD
+        if (HasAvx())
+        {
+            i = SquareAvx(input, output, size);
+        }
+#endif
+        for (; i < size; ++i)
+        {
+            output[i] = input[i] * input[i];
+        }
+    }
+
+    static void Cube(const double* input, double* output, size_t size)
+    {
+        size_t i = 0;
+#ifdef LAB24_X86_SIMD
+        if (HasAvx())
+        {
+            i = CubeAvx(input, output, size);
+        }
+#endif
+        for (; i < size; ++i)
+        {
+            output[i] = input[i] * input[i] * input[i];
+        }
+    }
+
+    static bool HasNegative(const double* input, size_t size)
+    {
+        size_t i = 0;
+        size_t negatives = 0;
+#ifdef LAB24_X86_SIMD
+        if (HasAvx())
+        {
+            i = CountNegativeAvx(input, size, negatives);
+        }
+#endif
+        for (; i < size; ++i)
+        {
+            negatives += input[i] < 0.0 ? 1 : 0;
+        }
+
+        return negatives > 0;
+    }
+
+    // Negative inputs yield NaN; callers that must reject them check with HasNegative first.
+    static void SquareRoot(const double* input, double* output, size_t size)
+    {
+        size_t i = 0;
+#ifdef LAB24_X86_SIMD
+        if (HasAvx())
+        {
+            i = SquareRootAvx(input, output, size);
+        }
+#endif
+        for (; i < size; ++i)
+        {
+            output[i] = std::sqrt(input[i]);
+        }
+    }
+
+    // Writes the indices of values that are outside [quietLow, quietHigh] or inside [hotLow, hotHigh]
+    // (NaN counts as outside) and returns how many were written.
+    static size_t SelectCandidates(const double* values, size_t size, double quietLow, double quietHigh,
+                                   double hotLow, double hotHigh, std::uint32_t* indices)
+    {
+        size_t i = 0;
+        size_t selected = 0;
+#ifdef LAB24_X86_SIMD
+        if (HasAvx())
+        {
+            i = SelectCandidatesAvx(values, size, quietLow, quietHigh, hotLow, hotHigh, indices, selected);
+        }
+#endif
+        for (; i < size; ++i)
+        {
+            const bool quiet = quietLow <= values[i] && values[i] <= quietHigh;
+            const bool hot = hotLow <= values[i] && values[i] <= hotHigh;
+            if (!quiet || hot)
+            {
+                indices[selected++] = static_cast<std::uint32_t>(i);
+            }
+        }
+
+        return selected;
+    }
+};
+
 class INumericOperationStrategy
 {
 public:
     virtual ~INumericOperationStrategy() = default;
     virtual double Execute(double value) const = 0;
     virtual std::string GetOperationName() const = 0;
+
+    // input and output have the same length; output may alias input.
+    virtual void ExecuteBatch(std::span<const double> input, std::span<double> output) const
+    {
+        for (size_t i = 0; i < input.size(); ++i)
+        {
+            output[i] = Execute(input[i]);
+        }
+    }
 };
 
-class SquareOperationStrategy : public INumericOperationStrategy
+class SquareOperationStrategy final : public INumericOperationStrategy
 {
 public:
     double Execute(double value) const override
@@ -22,13 +244,18 @@ public:
         return value * value;
     }
 
+    void ExecuteBatch(std::span<const double> input, std::span<double> output) const override
+    {
+        NumericKernels::Square(input.data(), output.data(), input.size());
+    }
+
     std::string GetOperationName() const override
     {
         return "square";
     }
 };
 
-class CubeOperationStrategy : public INumericOperationStrategy
+class CubeOperationStrategy final : public INumericOperationStrategy
 {
 public:
     double Execute(double value) const override
@@ -36,13 +263,18 @@ public:
         return value * value * value;
     }
 
+    void ExecuteBatch(std::span<const double> input, std::span<double> output) const override
+    {
+        NumericKernels::Cube(input.data(), output.data(), input.size());
+    }
+
     std::string GetOperationName() const override
     {
         return "cube";
     }
 };
 
-class SquareRootOperationStrategy : public INumericOperationStrategy
+class SquareRootOperationStrategy final : public INumericOperationStrategy
 {
 public:
     double Execute(double value) const override
@@ -55,167 +287,2775 @@ public:
         return std::sqrt(value);
     }
 
+    // Validates and computes one cache-sized chunk at a time so the input is streamed from memory once.
+    // On a negative input the chunks before it are already written.
+    void ExecuteBatch(std::span<const double> input, std::span<double> output) const override
+    {
+        constexpr size_t ChunkSize = 2048;
+        for (size_t offset = 0; offset < input.size(); offset += ChunkSize)
+        {
+            const size_t size = std::min(ChunkSize, input.size() - offset);
+            if (NumericKernels::HasNegative(input.data() + offset, size))
+            {
+                throw std::invalid_argument("square root strategy expects non-negative input");
+            }
+
+            NumericKernels::SquareRoot(input.data() + offset, output.data() + offset, size);
+        }
+    }
+
     std::string GetOperationName() const override
     {
         return "squareroot";
     }
 };
 
-class NumericProcessor
+template <typename Function>
+class LambdaOperationStage
 {
 private:
-    const INumericOperationStrategy* currentStrategy;
+    std::string name;
+    Function function;
 
 public:
-    explicit NumericProcessor(const INumericOperationStrategy* strategy)
-        : currentStrategy(strategy)
+    LambdaOperationStage(std::string stageName, Function stageFunction)
+        : name(std::move(stageName)), function(std::move(stageFunction))
     {
     }
 
-    void SetStrategy(const INumericOperationStrategy* strategy)
+    double Execute(double value) const
     {
-        currentStrategy = strategy;
+        return function(value);
     }
 
-    double Process(double input) const
+    void ExecuteBatch(std::span<const double> input, std::span<double> output) const
     {
-        return currentStrategy->Execute(input);
+        for (size_t i = 0; i < input.size(); ++i)
+        {
+            output[i] = function(input[i]);
+        }
     }
 
-    std::string GetCurrentOperationName() const
+    std::string GetOperationName() const
     {
-        return currentStrategy->GetOperationName();
+        return name;
     }
 };
 
-class ResultPublisher
+template <typename Function>
+LambdaOperationStage<Function> MakeOperationStage(std::string name, Function function)
 {
-public:
-    using ResultCalculatedHandler = std::function<void(double, const std::string&)>;
+    return LambdaOperationStage<Function>(std::move(name), std::move(function));
+}
 
+// Stages are held by value with their concrete types, so every stage call below is resolved at
+// compile time and inlined; only the composed pipeline is reachable through the virtual interface.
+template <typename... Stages>
+class FusedOperationStrategy final : public INumericOperationStrategy
+{
 private:
-    std::vector<ResultCalculatedHandler> subscribers;
+    static_assert(sizeof...(Stages) > 0, "a fused operation needs at least one stage");
+
+    // Small enough that the chunk stays in L1 while every stage runs over it.
+    static constexpr size_t ChunkSize = 1024;
+
+    std::tuple<Stages...> stages;
 
 public:
-    void Subscribe(const ResultCalculatedHandler& handler)
+    explicit FusedOperationStrategy(Stages... operationStages)
+        : stages(std::move(operationStages)...)
     {
-        subscribers.push_back(handler);
     }
 
-    void PublishResult(double result, const std::string& operationName) const
+    double Execute(double value) const override
     {
-        for (const auto& subscriber : subscribers)
+        return std::apply(
+            [value](const auto&... stage)
+            {
+                double result = value;
+                ((result = stage.Execute(result)), ...);
+                return result;
+            },
+            stages);
+    }
+
+    void ExecuteBatch(std::span<const double> input, std::span<double> output) const override
+    {
+        for (size_t offset = 0; offset < input.size(); offset += ChunkSize)
         {
-            subscriber(result, operationName);
+            const size_t size = std::min(ChunkSize, input.size() - offset);
+            const std::span<double> chunk = output.subspan(offset, size);
+
+            std::apply(
+                [&input, &chunk, offset, size](const auto& first, const auto&... rest)
+                {
+                    first.ExecuteBatch(input.subspan(offset, size), chunk);
+                    (rest.ExecuteBatch(chunk, chunk), ...);
+                },
+                stages);
         }
     }
-};
 
-class ConsoleLoggerObserver
-{
-public:
-    void OnResultCalculated(double result, const std::string& operationName) const
+    std::string GetOperationName() const override
     {
-        std::cout << "[consoleloggerobserver] operation=" << operationName
-                  << ", result=" << result << std::endl;
+        return std::apply(
+            [](const auto&... stage)
+            {
+                std::string name;
+                ((name += (name.empty() ? "" : ">") + stage.GetOperationName()), ...);
+                return name;
+            },
+            stages);
     }
 };
 
-class HistoryLoggerObserver
+template <typename... Stages>
+FusedOperationStrategy<std::decay_t<Stages>...> ComposeOperations(Stages&&... stages)
 {
-private:
-    std::vector<std::string> history;
+    return FusedOperationStrategy<std::decay_t<Stages>...>(std::forward<Stages>(stages)...);
+}
 
+// Formula over x such as "sqrt(x*x+1)", parsed once, constant-folded and compiled to register bytecode.
+// Supports + - * / ^, unary minus, parentheses and sqrt, abs, exp, log, sin, cos, min, max, pow.
+// Evaluation follows IEEE rules, so sqrt or log of a negative value yields NaN instead of throwing.
+class ExpressionOperationStrategy final : public INumericOperationStrategy
+{
 public:
-    void OnResultCalculated(double result, const std::string& operationName)
+    static constexpr size_t MaxRegisters = 16;
+    static constexpr size_t MaxDepth = 256;
+    static constexpr size_t MaxNodes = size_t(1) << 20;
+
+private:
+    enum class OpCode : std::uint8_t
     {
-        std::ostringstream entry;
-        entry << operationName << " -> " << result;
-        history.push_back(entry.str());
-    }
+        LoadInput,
+        LoadConstant,
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Power,
+        Minimum,
+        Maximum,
+        AddConstant,
+        MultiplyConstant,
+        SubtractConstant,
+        SubtractFromConstant,
+        DivideByConstant,
+        DivideConstantBy,
+        Negate,
+        Square,
+        Cube,
+        SquareRoot,
+        Absolute,
+        Exponent,
+        Logarithm,
+        Sine,
+        Cosine
+    };
 
-    void PrintHistory() const
+    struct Instruction
     {
-        std::cout << "\n[historyloggerobserver] stored history:" << std::endl;
+        OpCode op;
+        std::uint8_t target;
+        std::uint8_t left;
+        std::uint8_t right;
+        double constant;
+    };
+
+    struct Node
+    {
+        OpCode op;
+        double constant = 0.0;
+        int left = -1;
+        int right = -1;
+    };
+
+    // Recursive descent parser. Parentheses, function calls, unary signs and exponents nest at most
+    // MaxDepth levels deep and the tree holds at most MaxNodes nodes; chains of binary operators
+    // are parsed in a loop and may be arbitrarily long.
+    class Parser
+    {
+    private:
+        std::string_view text;
+        size_t position = 0;
+        size_t nesting = 0;
+        std::vector<Node>& nodes;
+
+        [[noreturn]] void Fail(const std::string& message) const
+        {
+            throw std::invalid_argument("expression error at position " + std::to_string(position) + ": " + message);
+        }
+
+        void SkipSpaces()
+        {
+            while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position])))
+            {
+                ++position;
+            }
+        }
+
+        bool Accept(char symbol)
+        {
+            SkipSpaces();
+            if (position < text.size() && text[position] == symbol)
+            {
+                ++position;
+                return true;
+            }
+
+            return false;
+        }
+
+        void Expect(char symbol)
+        {
+            if (!Accept(symbol))
+            {
+                Fail(std::string("expected '") + symbol + "'");
+            }
+        }
+
+        int Add(OpCode op, int left = -1, int right = -1, double constant = 0.0)
+        {
+            if (nodes.size() >= MaxNodes)
+            {
+                Fail("expression has more than " + std::to_string(MaxNodes) + " nodes");
+            }
+
+            nodes.push_back(Node{op, constant, left, right});
+            return static_cast<int>(nodes.size()) - 1;
+        }
+
+        int ParsePrimary()
+        {
+            SkipSpaces();
+            if (position == text.size())
+            {
+                Fail("unexpected end of expression");
+            }
+
+            if (Accept('('))
+            {
+                const int inner = ParseExpression();
+                Expect(')');
+                return inner;
+            }
+
+            const char symbol = text[position];
+            if (std::isdigit(static_cast<unsigned char>(symbol)) || symbol == '.')
+            {
+                double value = 0.0;
+                const auto [end, error] = std::from_chars(text.data() + position, text.data() + text.size(), value);
+                if (error != std::errc())
+                {
+                    Fail("invalid number");
+                }
+
+                position = static_cast<size_t>(end - text.data());
+                return Add(OpCode::LoadConstant, -1, -1, value);
+            }
+
+            const size_t start = position;
+            while (position < text.size() && std::isalpha(static_cast<unsigned char>(text[position])))
+            {
+                ++position;
+            }
+
+            const std::string_view name = text.substr(start, position - start);
+            if (name.empty())
+            {
+                Fail(std::string("unexpected '") + symbol + "'");
+            }
+            if (name == "x")
+            {
+                return Add(OpCode::LoadInput);
+            }
+
+            static const std::pair<std::string_view, OpCode> unaryFunctions[] = {
+                {"sqrt", OpCode::SquareRoot}, {"abs", OpCode::Absolute}, {"exp", OpCode::Exponent},
+                {"log", OpCode::Logarithm}, {"sin", OpCode::Sine}, {"cos", OpCode::Cosine}};
+            static const std::pair<std::string_view, OpCode> binaryFunctions[] = {
+                {"min", OpCode::Minimum}, {"max", OpCode::Maximum}, {"pow", OpCode::Power}};
+
+            for (const auto& [functionName, op] : unaryFunctions)
+            {
+                if (name == functionName)
+                {
+                    Expect('(');
+                    const int argument = ParseExpression();
+                    Expect(')');
+                    return Add(op, argument);
+                }
+            }
+
+            for (const auto& [functionName, op] : binaryFunctions)
+            {
+                if (name == functionName)
+                {
+                    Expect('(');
+                    const int left = ParseExpression();
+                    Expect(',');
+                    const int right = ParseExpression();
+                    Expect(')');
+                    return Add(op, left, right);
+                }
+            }
+
+            Fail("unknown name '" + std::string(name) + "'");
+        }
+
+        int ParsePower()
+        {
+            const int base = ParsePrimary();
+            if (Accept('^'))
+            {
+                return Add(OpCode::Power, base, ParseUnary());
+            }
+
+            return base;
+        }
+
+        // Every recursive path (parentheses, function arguments, unary signs, exponents) passes
+        // through here, so this is where parser recursion is bounded.
+        int ParseUnary()
+        {
+            if (++nesting > MaxDepth)
+            {
+                Fail("expression is nested deeper than " + std::to_string(MaxDepth) + " levels");
+            }
+
+            int result;
+            if (Accept('-'))
+            {
+                result = Add(OpCode::Negate, ParseUnary());
+            }
+            else if (Accept('+'))
+            {
+                result = ParseUnary();
+            }
+            else
+            {
+                result = ParsePower();
+            }
+
+            --nesting;
+            return result;
+        }
+
+        int ParseTerm()
+        {
+            int left = ParseUnary();
+            while (true)
+            {
+                if (Accept('*'))
+                {
+                    left = Add(OpCode::Multiply, left, ParseUnary());
+                }
+                else if (Accept('/'))
+                {
+                    left = Add(OpCode::Divide, left, ParseUnary());
+                }
+                else
+                {
+                    return left;
+                }
+            }
+        }
+
+        int ParseExpression()
+        {
+            int left = ParseTerm();
+            while (true)
+            {
+                if (Accept('+'))
+                {
+                    left = Add(OpCode::Add, left, ParseTerm());
+                }
+                else if (Accept('-'))
+                {
+                    left = Add(OpCode::Subtract, left, ParseTerm());
+                }
+                else
+                {
+                    return left;
+                }
+            }
+        }
+
+    public:
+        Parser(std::string_view source, std::vector<Node>& tree)
+            : text(source), nodes(tree)
+        {
+        }
+
+        int Parse()
+        {
+            const int root = ParseExpression();
+            SkipSpaces();
+            if (position != text.size())
+            {
+                Fail("unexpected trailing input");
+            }
+
+            return root;
+        }
+    };
+
+    std::string source;
+    std::vector<Node> nodes;
+    int root = -1;
+    std::vector<int> order;
+    std::vector<size_t> registerNeeds;
+    std::vector<Instruction> program;
+    size_t registerCount = 0;
+    size_t treeStackSize = 0;
 
-        for (const std::string& entry : history)
+    static double Apply(OpCode op, double left, double right)
+    {
+        switch (op)
         {
-            std::cout << "- " << entry << std::endl;
+        case OpCode::Add:
+        case OpCode::AddConstant:
+            return left + right;
+        case OpCode::Subtract:
+        case OpCode::SubtractConstant:
+            return left - right;
+        case OpCode::SubtractFromConstant:
+            return right - left;
+        case OpCode::Multiply:
+        case OpCode::MultiplyConstant:
+            return left * right;
+        case OpCode::Divide:
+        case OpCode::DivideByConstant:
+            return left / right;
+        case OpCode::DivideConstantBy:
+            return right / left;
+        case OpCode::Power:
+            return std::pow(left, right);
+        case OpCode::Minimum:
+            return std::min(left, right);
+        case OpCode::Maximum:
+            return std::max(left, right);
+        case OpCode::Negate:
+            return -left;
+        case OpCode::Square:
+            return left * left;
+        case OpCode::Cube:
+            return left * left * left;
+        case OpCode::SquareRoot:
+            return std::sqrt(left);
+        case OpCode::Absolute:
+            return std::fabs(left);
+        case OpCode::Exponent:
+            return std::exp(left);
+        case OpCode::Logarithm:
+            return std::log(left);
+        case OpCode::Sine:
+            return std::sin(left);
+        case OpCode::Cosine:
+            return std::cos(left);
+        default:
+            return left;
         }
     }
-};
 
-class ThresholdNotifierObserver
-{
-private:
-    double threshold;
+    static bool UsesConstant(OpCode op)
+    {
+        return op >= OpCode::AddConstant && op <= OpCode::DivideConstantBy;
+    }
 
-public:
-    explicit ThresholdNotifierObserver(double thresholdValue)
-        : threshold(thresholdValue)
+    bool IsConstant(int node) const
     {
+        return node >= 0 && nodes[static_cast<size_t>(node)].op == OpCode::LoadConstant;
     }
 
-    void OnResultCalculated(double result, const std::string& operationName) const
+    // Lists the nodes under start with every child before its parent. The walk uses an explicit
+    // stack, so arbitrarily long operator chains cannot overflow the call stack.
+    std::vector<int> PostOrder(int start) const
     {
-        if (result > threshold)
+        std::vector<int> order;
+        std::vector<std::pair<int, bool>> pending{{start, false}};
+        while (!pending.empty())
         {
-            std::cout << "[thresholdnotifierobserver] " << operationName
-                      << " result " << result
-                      << " is above threshold " << threshold << std::endl;
+            const auto [index, childrenListed] = pending.back();
+            pending.pop_back();
+            if (childrenListed)
+            {
+                order.push_back(index);
+                continue;
+            }
+
+            const Node& node = nodes[static_cast<size_t>(index)];
+            pending.push_back({index, true});
+            if (node.right >= 0)
+            {
+                pending.push_back({node.right, false});
+            }
+            if (node.left >= 0)
+            {
+                pending.push_back({node.left, false});
+            }
         }
-    }
-};
 
-void ProcessAndPublishResult(
-    NumericProcessor& processor,
-    const ResultPublisher& publisher,
-    double value)
-{
-    const double result = processor.Process(value);
-    const std::string operationName = processor.GetCurrentOperationName();
+        return order;
+    }
 
-    publisher.PublishResult(result, operationName);
-}
+    // Folds constant subtrees bottom-up and strength-reduces x^2 and x^3.
+    void Fold()
+    {
+        for (const int index : PostOrder(root))
+        {
+            Node& node = nodes[static_cast<size_t>(index)];
+            if (node.op == OpCode::LoadInput || node.op == OpCode::LoadConstant)
+            {
+                continue;
+            }
 
-int main()
-{
-    SquareOperationStrategy squareStrategy;
-    CubeOperationStrategy cubeStrategy;
-    SquareRootOperationStrategy squareRootStrategy;
+            const bool leftConstant = IsConstant(node.left);
+            const bool rightConstant = node.right < 0 || IsConstant(node.right);
+            if (leftConstant && rightConstant)
+            {
+                const double left = nodes[static_cast<size_t>(node.left)].constant;
+                const double right = node.right >= 0 ? nodes[static_cast<size_t>(node.right)].constant : 0.0;
+                node = Node{OpCode::LoadConstant, Apply(node.op, left, right)};
+                continue;
+            }
 
-    NumericProcessor processor(&squareStrategy);
-    ResultPublisher publisher;
+            if (node.op == OpCode::Power && IsConstant(node.right))
+            {
+                const double exponent = nodes[static_cast<size_t>(node.right)].constant;
+                if (exponent == 1.0)
+                {
+                    node = nodes[static_cast<size_t>(node.left)];
+                }
+                else if (exponent == 2.0)
+                {
+                    node = Node{OpCode::Square, 0.0, node.left};
+                }
+                else if (exponent == 3.0)
+                {
+                    node = Node{OpCode::Cube, 0.0, node.left};
+                }
+            }
+        }
+    }
 
-    ConsoleLoggerObserver consoleLogger;
-    HistoryLoggerObserver historyLogger;
-    ThresholdNotifierObserver thresholdNotifier(50.0);
+    bool HasImmediateForm(const Node& node) const
+    {
+        const bool immediateOp = node.op == OpCode::Add || node.op == OpCode::Multiply ||
+                                 node.op == OpCode::Subtract || node.op == OpCode::Divide;
+        return immediateOp && (IsConstant(node.left) || IsConstant(node.right));
+    }
 
-    publisher.Subscribe(
-        [&consoleLogger](double result, const std::string& operationName)
+    // Sethi-Ullman labelling: the number of registers a subtree needs when its more demanding
+    // operand is evaluated first. Children come before parents in order, so their needs are known.
+    size_t CountRegisters()
+    {
+        registerNeeds.assign(nodes.size(), 1);
+        for (const int index : order)
         {
-            consoleLogger.OnResultCalculated(result, operationName);
-        });
+            const Node& node = nodes[static_cast<size_t>(index)];
+            size_t needed = 1;
+            if (node.op != OpCode::LoadInput && node.op != OpCode::LoadConstant)
+            {
+                if (node.right < 0)
+                {
+                    needed = registerNeeds[static_cast<size_t>(node.left)];
+                }
+                else if (HasImmediateForm(node))
+                {
+                    needed = registerNeeds[static_cast<size_t>(IsConstant(node.right) ? node.left : node.right)];
+                }
+                else
+                {
+                    const size_t left = registerNeeds[static_cast<size_t>(node.left)];
+                    const size_t right = registerNeeds[static_cast<size_t>(node.right)];
+                    needed = left == right ? left + 1 : std::max(left, right);
+                }
+            }
+
+            registerNeeds[static_cast<size_t>(index)] = needed;
+        }
+
+        return registerNeeds[static_cast<size_t>(root)];
+    }
 
-    publisher.Subscribe(
-        [&historyLogger](double result, const std::string& operationName)
+    // Emits the program depth-first with an explicit stack. A pending entry either visits a node
+    // into a target register or, when index is negative, appends an instruction whose operands
+    // have been emitted by the entries above it.
+    void Emit()
+    {
+        struct Pending
         {
-            historyLogger.OnResultCalculated(result, operationName);
-        });
+            int index;
+            std::uint8_t target;
+            Instruction instruction;
+        };
 
-    publisher.Subscribe(
-        [&thresholdNotifier](double result, const std::string& operationName)
+        std::vector<Pending> pending{{root, 0, Instruction{}}};
+        while (!pending.empty())
         {
-            thresholdNotifier.OnResultCalculated(result, operationName);
-        });
+            const Pending current = pending.back();
+            pending.pop_back();
+            if (current.index < 0)
+            {
+                program.push_back(current.instruction);
+                continue;
+            }
 
-    std::cout << "=== strategy + observer demo ===" << std::endl;
+            const Node node = nodes[static_cast<size_t>(current.index)];
+            const std::uint8_t target = current.target;
+            if (node.op == OpCode::LoadInput || node.op == OpCode::LoadConstant)
+            {
+                program.push_back(Instruction{node.op, target, target, target, node.constant});
+                continue;
+            }
 
-    processor.SetStrategy(&squareStrategy);
-    ProcessAndPublishResult(processor, publisher, 4.0);
-    ProcessAndPublishResult(processor, publisher, 8.0);
+            // Unary and immediate instructions name their own register as the unused right operand,
+            // so the interpreters never read a register that has not been written.
+            if (node.right < 0)
+            {
+                pending.push_back({-1, 0, Instruction{node.op, target, target, target, 0.0}});
+                pending.push_back({node.left, target, Instruction{}});
+                continue;
+            }
 
-    processor.SetStrategy(&cubeStrategy);
+            // A constant operand becomes an immediate instead of occupying a register.
+            if (HasImmediateForm(node))
+            {
+                static const std::tuple<OpCode, OpCode, OpCode> immediateForms[] = {
+                    {OpCode::Add, OpCode::AddConstant, OpCode::AddConstant},
+                    {OpCode::Multiply, OpCode::MultiplyConstant, OpCode::MultiplyConstant},
+                    {OpCode::Subtract, OpCode::SubtractConstant, OpCode::SubtractFromConstant},
+                    {OpCode::Divide, OpCode::DivideByConstant, OpCode::DivideConstantBy}};
+                for (const auto& [op, constantRight, constantLeft] : immediateForms)
+                {
+                    if (node.op != op)
+                    {
+                        continue;
+                    }
+
+                    const bool rightConstant = IsConstant(node.right);
+                    const double constant = nodes[static_cast<size_t>(rightConstant ? node.right : node.left)].constant;
+                    pending.push_back({-1, 0, Instruction{rightConstant ? constantRight : constantLeft, target, target, target, constant}});
+                    pending.push_back({rightConstant ? node.left : node.right, target, Instruction{}});
+                    break;
+                }
+                continue;
+            }
+
+            // The operand that needs more registers is evaluated first, into the lower register.
+            const auto next = static_cast<std::uint8_t>(target + 1);
+            if (registerNeeds[static_cast<size_t>(node.right)] > registerNeeds[static_cast<size_t>(node.left)])
+            {
+                pending.push_back({-1, 0, Instruction{node.op, target, next, target, 0.0}});
+                pending.push_back({node.left, next, Instruction{}});
+                pending.push_back({node.right, target, Instruction{}});
+            }
+            else
+            {
+                pending.push_back({-1, 0, Instruction{node.op, target, target, next, 0.0}});
+                pending.push_back({node.right, next, Instruction{}});
+                pending.push_back({node.left, target, Instruction{}});
+            }
+        }
+    }
+
+    // The most values the post-order evaluation in EvaluateTree holds at once.
+    size_t CountTreeStack() const
+    {
+        size_t depth = 0;
+        size_t deepest = 0;
+        for (const int index : order)
+        {
+            const Node& node = nodes[static_cast<size_t>(index)];
+            if (node.op == OpCode::LoadInput || node.op == OpCode::LoadConstant)
+            {
+                deepest = std::max(deepest, ++depth);
+            }
+            else if (node.right >= 0)
+            {
+                --depth;
+            }
+        }
+
+        return deepest;
+    }
+
+    template <size_t Width>
+    void Run(const double* input, double (*registers)[Width], size_t size) const
+    {
+        for (const Instruction& instruction : program)
+        {
+            double* target = registers[instruction.target];
+            const double* left = registers[instruction.left];
+            const double* right = registers[instruction.right];
+            const double constant = instruction.constant;
+
+            switch (instruction.op)
+            {
+            case OpCode::LoadInput:
+                std::copy(input, input + size, target);
+                break;
+            case OpCode::LoadConstant:
+                std::fill(target, target + size, constant);
+                break;
+            case OpCode::Add:
+                for (size_t i = 0; i < size; ++i)
+                {
+                    target[i] = left[i] + right[i];
+                }
+                break;
+            case OpCode::Subtract:
+                for (size_t i = 0; i < size; ++i)
+                {
+                    target[i] = left[i] - right[i];
+                }
+                break;
+            case OpCode::Multiply:
+                for (size_t i = 0; i < size; ++i)
+                {
+                    target[i] = left[i] * right[i];
+                }
+                break;
+            case OpCode::Divide:
+                for (size_t i = 0; i < size; ++i)
+                {
+                    target[i] = left[i] / right[i];
+                }
+                break;
+            case OpCode::AddConstant:
+                for (size_t i = 0; i < size; ++i)
+                {
+                    target[i] = left[i] + constant;
+                }
+                break;
+            case OpCode::MultiplyConstant:
+                for (size_t i = 0; i < size; ++i)
+                {
+                    target[i] = left[i] * constant;
+                }
+                break;
+            case OpCode::SubtractConstant:
+                for (size_t i = 0; i < size; ++i)
+                {
+                    target[i] = left[i] - constant;
+                }
+                break;
+            case OpCode::SubtractFromConstant:
+                for (size_t i = 0; i < size; ++i)
+                {
+                    target[i] = constant - left[i];
+                }
+                break;
+            case OpCode::DivideByConstant:
+                for (size_t i = 0; i < size; ++i)
+                {
+                    target[i] = left[i] / constant;
+                }
+                break;
+            case OpCode::DivideConstantBy:
+                for (size_t i = 0; i < size; ++i)
+                {
+                    target[i] = constant / left[i];
+                }
+                break;
+            case OpCode::Negate:
+                for (size_t i = 0; i < size; ++i)
+                {
+                    target[i] = -left[i];
+                }
+                break;
+            case OpCode::Square:
+                NumericKernels::Square(left, target, size);
+                break;
+            case OpCode::Cube:
+                for (size_t i = 0; i < size; ++i)
+                {
+                    target[i] = left[i] * left[i] * left[i];
+                }
+                break;
+            case OpCode::SquareRoot:
+                NumericKernels::SquareRoot(left, target, size);
+                break;
+            default:
+                for (size_t i = 0; i < size; ++i)
+                {
+                    target[i] = Apply(instruction.op, left[i], right[i]);
+                }
+                break;
+            }
+        }
+    }
+
+public:
+    explicit ExpressionOperationStrategy(std::string formula)
+        : source(std::move(formula))
+    {
+        root = Parser(source, nodes).Parse();
+        Fold();
+        order = PostOrder(root);
+        treeStackSize = CountTreeStack();
+
+        registerCount = CountRegisters();
+        if (registerCount > MaxRegisters)
+        {
+            throw std::invalid_argument("expression needs more than " + std::to_string(MaxRegisters) + " registers");
+        }
+
+        Emit();
+    }
+
+    double Execute(double value) const override
+    {
+        double registers[MaxRegisters];
+        for (const Instruction& instruction : program)
+        {
+            switch (instruction.op)
+            {
+            case OpCode::LoadInput:
+                registers[instruction.target] = value;
+                break;
+            case OpCode::LoadConstant:
+                registers[instruction.target] = instruction.constant;
+                break;
+            default:
+                registers[instruction.target] = Apply(instruction.op, registers[instruction.left],
+                                                      UsesConstant(instruction.op) ? instruction.constant
+                                                                                   : registers[instruction.right]);
+                break;
+            }
+        }
+
+        return registers[0];
+    }
+
+    // Runs each instruction over a block of values at a time, so dispatch is paid once per block
+    // and the inner loops are plain array arithmetic.
+    void ExecuteBatch(std::span<const double> input, std::span<double> output) const override
+    {
+        constexpr size_t BlockSize = 256;
+        double registers[MaxRegisters][BlockSize];
+        for (size_t offset = 0; offset < input.size(); offset += BlockSize)
+        {
+            const size_t size = std::min(BlockSize, input.size() - offset);
+            Run<BlockSize>(input.data() + offset, registers, size);
+            std::copy(registers[0], registers[0] + size, output.data() + offset);
+        }
+    }
+
+    std::string GetOperationName() const override
+    {
+        return source;
+    }
+
+    // Reference node-by-node evaluation of the folded tree in post-order, kept for verification and benchmarks.
+    double EvaluateTree(double value) const
+    {
+        double inlineValues[64];
+        std::vector<double> heapValues;
+        double* values = inlineValues;
+        if (treeStackSize > std::size(inlineValues))
+        {
+            heapValues.resize(treeStackSize);
+            values = heapValues.data();
+        }
+
+        // The root comes last in post-order, so the last value computed is the result.
+        size_t top = 0;
+        double result = 0.0;
+        for (const int index : order)
+        {
+            const Node& node = nodes[static_cast<size_t>(index)];
+            if (node.op == OpCode::LoadInput || node.op == OpCode::LoadConstant)
+            {
+                result = node.op == OpCode::LoadInput ? value : node.constant;
+                values[top++] = result;
+            }
+            else
+            {
+                const double right = node.right >= 0 ? values[--top] : 0.0;
+                result = Apply(node.op, values[top - 1], right);
+                values[top - 1] = result;
+            }
+        }
+
+        return result;
+    }
+
+    size_t GetInstructionCount() const
+    {
+        return program.size();
+    }
+
+    size_t GetRegisterCount() const
+    {
+        return registerCount;
+    }
+};
+
+enum class CacheEviction
+{
+    Fifo,
+    LeastRecentlyUsed
+};
+
+// Bounded memo table keyed by the bit pattern of the input. Each bucket is one 64-byte cache line
+// holding four slots, so a lookup touches a single line; a full bucket evicts by the chosen policy.
+// NaN inputs are never cached. Not thread-safe on its own.
+class MemoTable
+{
+private:
+    static constexpr size_t Ways = 4;
+    static constexpr std::uint64_t EmptyKey = 0x7FF8000000000000ull;
+    static constexpr std::uint8_t InitialRecency = 0xE4;
+
+    struct alignas(64) Bucket
+    {
+        std::uint64_t keys[Ways];
+        double values[Ways];
+    };
+
+    static_assert(sizeof(Bucket) == 64, "a memo bucket should fill exactly one cache line");
+
+    std::vector<Bucket> buckets;
+    // Per bucket: the next FIFO victim, or the slots from most to least recently used, two bits each.
+    std::vector<std::uint8_t> order;
+    unsigned shift = 0;
+    CacheEviction eviction;
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t evictions = 0;
+
+    size_t BucketOf(std::uint64_t key) const
+    {
+        key ^= key >> 29;
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift);
+    }
+
+    void Touch(size_t bucket, size_t slot)
+    {
+        const unsigned current = order[bucket];
+        unsigned position = 0;
+        while (((current >> (2 * position)) & 3u) != slot)
+        {
+            ++position;
+        }
+
+        const unsigned below = current & ((1u << (2 * position)) - 1u);
+        const unsigned above = current & ~((1u << (2 * position + 2)) - 1u);
+        order[bucket] = static_cast<std::uint8_t>(above | (below << 2) | static_cast<unsigned>(slot));
+    }
+
+public:
+    MemoTable(size_t capacity, CacheEviction evictionPolicy)
+        : eviction(evictionPolicy)
+    {
+        size_t bucketCount = 2;
+        unsigned bucketBits = 1;
+        while (bucketCount * Ways < capacity)
+        {
+            bucketCount *= 2;
+            ++bucketBits;
+        }
+
+        shift = 64 - bucketBits;
+        buckets.resize(bucketCount);
+        order.resize(bucketCount);
+        Clear();
+    }
+
+    bool Find(double input, double& result)
+    {
+        const auto key = std::bit_cast<std::uint64_t>(input);
+        if (!std::isnan(input))
+        {
+            const size_t bucket = BucketOf(key);
+            const Bucket& line = buckets[bucket];
+            for (size_t slot = 0; slot < Ways; ++slot)
+            {
+                if (line.keys[slot] == key)
+                {
+                    if (eviction == CacheEviction::LeastRecentlyUsed)
+                    {
+                        Touch(bucket, slot);
+                    }
+
+                    result = line.values[slot];
+                    ++hits;
+                    return true;
+                }
+            }
+        }
+
+        ++misses;
+        return false;
+    }
+
+    void Insert(double input, double result)
+    {
+        if (std::isnan(input))
+        {
+            return;
+        }
+
+        const auto key = std::bit_cast<std::uint64_t>(input);
+        const size_t bucket = BucketOf(key);
+        Bucket& line = buckets[bucket];
+
+        size_t target = Ways;
+        for (size_t slot = 0; slot < Ways; ++slot)
+        {
+            if (line.keys[slot] == key)
+            {
+                target = slot;
+                break;
+            }
+
+            if (target == Ways && line.keys[slot] == EmptyKey)
+            {
+                target = slot;
+            }
+        }
+
+        if (target == Ways)
+        {
+            ++evictions;
+            if (eviction == CacheEviction::LeastRecentlyUsed)
+            {
+                target = order[bucket] >> 6;
+            }
+            else
+            {
+                target = order[bucket];
+                order[bucket] = static_cast<std::uint8_t>((target + 1) % Ways);
+            }
+        }
+
+        line.keys[target] = key;
+        line.values[target] = result;
+        if (eviction == CacheEviction::LeastRecentlyUsed)
+        {
+            Touch(bucket, target);
+        }
+    }
+
+    void Clear()
+    {
+        for (Bucket& line : buckets)
+        {
+            std::fill(std::begin(line.keys), std::end(line.keys), EmptyKey);
+        }
+
+        std::fill(order.begin(), order.end(), eviction == CacheEviction::LeastRecentlyUsed ? InitialRecency : 0);
+    }
+
+    size_t GetCapacity() const
+    {
+        return buckets.size() * Ways;
+    }
+
+    std::uint64_t GetHitCount() const
+    {
+        return hits;
+    }
+
+    std::uint64_t GetMissCount() const
+    {
+        return misses;
+    }
+
+    std::uint64_t GetEvictionCount() const
+    {
+        return evictions;
+    }
+};
+
+// Decorator that memoises another strategy. Results keep the wrapped operation's name.
+// Use ConcurrentCachingOperationStrategy when several threads share one instance.
+class CachingOperationStrategy final : public INumericOperationStrategy
+{
+private:
+    const INumericOperationStrategy* strategy;
+    mutable MemoTable table;
+
+public:
+    explicit CachingOperationStrategy(const INumericOperationStrategy* wrappedStrategy, size_t capacity = 4096,
+                                      CacheEviction eviction = CacheEviction::LeastRecentlyUsed)
+        : strategy(wrappedStrategy), table(capacity, eviction)
+    {
+    }
+
+    double Execute(double value) const override
+    {
+        double result = 0.0;
+        if (table.Find(value, result))
+        {
+            return result;
+        }
+
+        result = strategy->Execute(value);
+        table.Insert(value, result);
+        return result;
+    }
+
+    // Serves cached values directly and computes only the misses of each chunk, in one batch call
+    // to the wrapped strategy.
+    void ExecuteBatch(std::span<const double> input, std::span<double> output) const override
+    {
+        constexpr size_t ChunkSize = 1024;
+        double missInputs[ChunkSize];
+        double missResults[ChunkSize];
+        std::uint32_t missIndices[ChunkSize];
+
+        for (size_t offset = 0; offset < input.size(); offset += ChunkSize)
+        {
+            const size_t size = std::min(ChunkSize, input.size() - offset);
+            size_t missCount = 0;
+            for (size_t i = offset; i < offset + size; ++i)
+            {
+                const double value = input[i];
+                if (!table.Find(value, output[i]))
+                {
+                    missInputs[missCount] = value;
+                    missIndices[missCount++] = static_cast<std::uint32_t>(i);
+                }
+            }
+
+            if (missCount == 0)
+            {
+                continue;
+            }
+
+            strategy->ExecuteBatch(std::span<const double>(missInputs, missCount), std::span<double>(missResults, missCount));
+            for (size_t miss = 0; miss < missCount; ++miss)
+            {
+                output[missIndices[miss]] = missResults[miss];
+                table.Insert(missInputs[miss], missResults[miss]);
+            }
+        }
+    }
+
+    std::string GetOperationName() const override
+    {
+        return strategy->GetOperationName();
+    }
+
+    void ClearCache()
+    {
+        table.Clear();
+    }
+
+    size_t GetCapacity() const
+    {
+        return table.GetCapacity();
+    }
+
+    std::uint64_t GetHitCount() const
+    {
+        return table.GetHitCount();
+    }
+
+    std::uint64_t GetMissCount() const
+    {
+        return table.GetMissCount();
+    }
+
+    std::uint64_t GetEvictionCount() const
+    {
+        return table.GetEvictionCount();
+    }
+};
+
+// Thread-safe variant: the table is split into up to 64 stripes chosen by an independent hash of the
+// input, each behind its own mutex. Misses are computed outside the lock, so a slow strategy never blocks
+// other stripes or other lookups in the same stripe.
+class ConcurrentCachingOperationStrategy final : public INumericOperationStrategy
+{
+public:
+    static constexpr size_t MaxStripes = 64;
+
+private:
+    struct alignas(64) Stripe
+    {
+        std::mutex mutex;
+        MemoTable table;
+
+        Stripe(size_t capacity, CacheEviction eviction)
+            : table(capacity, eviction)
+        {
+        }
+    };
+
+    const INumericOperationStrategy* strategy;
+    std::vector<std::unique_ptr<Stripe>> stripes;
+    unsigned stripeShift = 0;
+
+    size_t StripeIndexOf(double value) const
+    {
+        auto key = std::bit_cast<std::uint64_t>(value);
+        key ^= key >> 31;
+        return static_cast<size_t>((key * 0xBF58476D1CE4E5B9ull) >> stripeShift);
+    }
+
+    template <typename Getter>
+    std::uint64_t Sum(Getter getter) const
+    {
+        std::uint64_t total = 0;
+        for (const auto& stripe : stripes)
+        {
+            std::lock_guard<std::mutex> lock(stripe->mutex);
+            total += (stripe->table.*getter)();
+        }
+
+        return total;
+    }
+
+public:
+    explicit ConcurrentCachingOperationStrategy(const INumericOperationStrategy* wrappedStrategy, size_t capacity = 65536,
+                                                size_t stripeCount = 16,
+                                                CacheEviction eviction = CacheEviction::LeastRecentlyUsed)
+        : strategy(wrappedStrategy)
+    {
+        size_t count = 1;
+        unsigned stripeBits = 0;
+        while (count < std::min(stripeCount, MaxStripes))
+        {
+            count *= 2;
+            ++stripeBits;
+        }
+
+        // A shift by 64 is undefined, so a single stripe still keeps one hash bit and two entries.
+        if (stripeBits == 0)
+        {
+            count = 2;
+            stripeBits = 1;
+        }
+
+        stripeShift = 64 - stripeBits;
+        stripes.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            stripes.push_back(std::make_unique<Stripe>((capacity + count - 1) / count, eviction));
+        }
+    }
+
+    double Execute(double value) const override
+    {
+        Stripe& stripe = *stripes[StripeIndexOf(value)];
+        double result = 0.0;
+        {
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            if (stripe.table.Find(value, result))
+            {
+                return result;
+            }
+        }
+
+        result = strategy->Execute(value);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        stripe.table.Insert(value, result);
+        return result;
+    }
+
+    // Groups each chunk by stripe so every stripe is locked once for the lookups and once for the
+    // inserts of the chunk, instead of once per value.
+    void ExecuteBatch(std::span<const double> input, std::span<double> output) const override
+    {
+        constexpr size_t ChunkSize = 1024;
+        std::uint8_t stripeIndices[ChunkSize];
+        std::uint16_t grouped[ChunkSize];
+        double missInputs[ChunkSize];
+        double missResults[ChunkSize];
+        std::uint16_t missIndices[ChunkSize];
+        std::uint16_t groupStarts[MaxStripes + 1];
+
+        for (size_t offset = 0; offset < input.size(); offset += ChunkSize)
+        {
+            const size_t size = std::min(ChunkSize, input.size() - offset);
+            std::fill(groupStarts, groupStarts + stripes.size() + 1, 0);
+            for (size_t i = 0; i < size; ++i)
+            {
+                stripeIndices[i] = static_cast<std::uint8_t>(StripeIndexOf(input[offset + i]));
+                ++groupStarts[stripeIndices[i] + 1];
+            }
+
+            for (size_t stripe = 0; stripe < stripes.size(); ++stripe)
+            {
+                groupStarts[stripe + 1] = static_cast<std::uint16_t>(groupStarts[stripe + 1] + groupStarts[stripe]);
+            }
+
+            std::uint16_t next[MaxStripes];
+            std::copy(groupStarts, groupStarts + stripes.size(), next);
+            for (size_t i = 0; i < size; ++i)
+            {
+                grouped[next[stripeIndices[i]]++] = static_cast<std::uint16_t>(i);
+            }
+
+            // Misses come out ordered by stripe, which the insert pass below relies on.
+            size_t missCount = 0;
+            for (size_t stripe = 0; stripe < stripes.size(); ++stripe)
+            {
+                if (groupStarts[stripe] == groupStarts[stripe + 1])
+                {
+                    continue;
+                }
+
+                std::lock_guard<std::mutex> lock(stripes[stripe]->mutex);
+                for (size_t position = groupStarts[stripe]; position < groupStarts[stripe + 1]; ++position)
+                {
+                    const size_t i = grouped[position];
+                    const double value = input[offset + i];
+                    if (!stripes[stripe]->table.Find(value, output[offset + i]))
+                    {
+                        missInputs[missCount] = value;
+                        missIndices[missCount++] = static_cast<std::uint16_t>(i);
+                    }
+                }
+            }
+
+            if (missCount == 0)
+            {
+                continue;
+            }
+
+            strategy->ExecuteBatch(std::span<const double>(missInputs, missCount), std::span<double>(missResults, missCount));
+            for (size_t miss = 0; miss < missCount;)
+            {
+                const size_t stripe = stripeIndices[missIndices[miss]];
+                std::lock_guard<std::mutex> lock(stripes[stripe]->mutex);
+                for (; miss < missCount && stripeIndices[missIndices[miss]] == stripe; ++miss)
+                {
+                    output[offset + missIndices[miss]] = missResults[miss];
+                    stripes[stripe]->table.Insert(missInputs[miss], missResults[miss]);
+                }
+            }
+        }
+    }
+
+    std::string GetOperationName() const override
+    {
+        return strategy->GetOperationName();
+    }
+
+    void ClearCache()
+    {
+        for (const auto& stripe : stripes)
+        {
+            std::lock_guard<std::mutex> lock(stripe->mutex);
+            stripe->table.Clear();
+        }
+    }
+
+    size_t GetStripeCount() const
+    {
+        return stripes.size();
+    }
+
+    std::uint64_t GetHitCount() const
+    {
+        return Sum(&MemoTable::GetHitCount);
+    }
+
+    std::uint64_t GetMissCount() const
+    {
+        return Sum(&MemoTable::GetMissCount);
+    }
+
+    std::uint64_t GetEvictionCount() const
+    {
+        return Sum(&MemoTable::GetEvictionCount);
+    }
+};
+
+// Deliberate copy of the pool in lab25/lab25.cpp: every lab builds from a single file. Apply fixes to both.
+class WorkStealingPool
+{
+private:
+    struct alignas(64) WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queuedTasks{0};
+    std::atomic<size_t> nextQueue{0};
+    std::atomic<bool> running{true};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+
+    bool TryPopOwn(size_t index, std::function<void()>& task)
+    {
+        WorkerQueue& queue = *queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+        {
+            return false;
+        }
+
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool TrySteal(size_t thief, std::function<void()>& task)
+    {
+        for (size_t offset = 1; offset <= queues.size(); ++offset)
+        {
+            WorkerQueue& queue = *queues[(thief + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty())
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool RunOne(size_t index)
+    {
+        std::function<void()> task;
+        if (!TryPopOwn(index, task) && !TrySteal(index, task))
+        {
+            return false;
+        }
+
+        queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+        task();
+        return true;
+    }
+
+    void RunWorker(size_t index)
+    {
+        while (running.load(std::memory_order_acquire))
+        {
+            if (RunOne(index))
+            {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this]()
+            {
+                return !running.load(std::memory_order_acquire) || queuedTasks.load(std::memory_order_relaxed) > 0;
+            });
+        }
+    }
+
+public:
+    explicit WorkStealingPool(size_t threadCount = std::thread::hardware_concurrency())
+    {
+        threadCount = std::max<size_t>(threadCount, 1);
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            workers.emplace_back([this, i]() { RunWorker(i); });
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    ~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            running.store(false, std::memory_order_release);
+        }
+        wake.notify_all();
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    size_t GetThreadCount() const
+    {
+        return workers.size();
+    }
+
+    // Runs body(0) .. body(count - 1) on the pool and returns when all of them finished. The calling
+    // thread executes and steals tasks while it waits, so nested calls from a task do not deadlock.
+    template <typename Body>
+    void ParallelFor(size_t count, Body&& body)
+    {
+        std::atomic<size_t> remaining{count};
+        std::exception_ptr failure;
+        std::mutex failureMutex;
+
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            queuedTasks.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            WorkerQueue& queue = *queues[nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.emplace_back([&, i]()
+            {
+                try
+                {
+                    body(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> failureLock(failureMutex);
+                    if (!failure)
+                    {
+                        failure = std::current_exception();
+                    }
+                }
+                remaining.fetch_sub(1, std::memory_order_acq_rel);
+            });
+        }
+
+        wake.notify_all();
+
+        const size_t helperIndex = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        while (remaining.load(std::memory_order_acquire) > 0)
+        {
+            if (!RunOne(helperIndex))
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        if (failure)
+        {
+            std::rethrow_exception(failure);
+        }
+    }
+};
+
+class NumericProcessor
+{
+private:
+    const INumericOperationStrategy* currentStrategy;
+
+public:
+    explicit NumericProcessor(const INumericOperationStrategy* strategy)
+        : currentStrategy(strategy)
+    {
+    }
+
+    void SetStrategy(const INumericOperationStrategy* strategy)
+    {
+        currentStrategy = strategy;
+    }
+
+    double Process(double input) const
+    {
+        return currentStrategy->Execute(input);
+    }
+
+    void ProcessBatch(std::span<const double> input, std::span<double> output) const
+    {
+        if (output.size() < input.size())
+        {
+            throw std::length_error("batch output must be at least as large as the input");
+        }
+
+        currentStrategy->ExecuteBatch(input, output.first(input.size()));
+    }
+
+    void ProcessBatchParallel(std::span<const double> input, std::span<double> output, WorkStealingPool& pool) const
+    {
+        if (output.size() < input.size())
+        {
+            throw std::length_error("batch output must be at least as large as the input");
+        }
+
+        static constexpr size_t ChunkSize = 16384;
+        pool.ParallelFor((input.size() + ChunkSize - 1) / ChunkSize, [this, input, output](size_t chunk)
+        {
+            const size_t offset = chunk * ChunkSize;
+            const size_t size = std::min(ChunkSize, input.size() - offset);
+            currentStrategy->ExecuteBatch(input.subspan(offset, size), output.subspan(offset, size));
+        });
+    }
+
+    std::string GetCurrentOperationName() const
+    {
+        return currentStrategy->GetOperationName();
+    }
+};
+
+using OperationId = std::uint32_t;
+
+class OperationRegistry
+{
+private:
+    std::mutex mutex;
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, OperationId> ids;
+
+    static OperationRegistry& GetInstance()
+    {
+        static OperationRegistry instance;
+        return instance;
+    }
+
+public:
+    static OperationId Intern(std::string_view name)
+    {
+        OperationRegistry& registry = GetInstance();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        auto found = registry.ids.find(name);
+        if (found != registry.ids.end())
+        {
+            return found->second;
+        }
+
+        const auto id = static_cast<OperationId>(registry.names.size());
+        registry.names.emplace_back(name);
+        registry.ids.emplace(registry.names.back(), id);
+        return id;
+    }
+
+    // Names are never removed and deque keeps them in place, so the reference stays valid.
+    static const std::string& GetName(OperationId id)
+    {
+        OperationRegistry& registry = GetInstance();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        return registry.names.at(id);
+    }
+};
+
+// Batches usually carry a single operation, so remembering the last id avoids a registry lock per record.
+class OperationNameLookup
+{
+private:
+    OperationId lastId = 0;
+    const std::string* lastName = nullptr;
+
+public:
+    const std::string& operator()(OperationId id)
+    {
+        if (lastName == nullptr || id != lastId)
+        {
+            lastId = id;
+            lastName = &OperationRegistry::GetName(id);
+        }
+
+        return *lastName;
+    }
+};
+
+struct ResultRecord
+{
+    double result;
+    OperationId operationId;
+};
+
+class ResultPublisher
+{
+public:
+    using ResultCalculatedHandler = std::function<void(double, const std::string&)>;
+    using ResultBatchHandler = std::function<void(std::span<const ResultRecord>)>;
+
+private:
+    std::vector<ResultCalculatedHandler> subscribers;
+    std::vector<ResultBatchHandler> batchSubscribers;
+
+public:
+    void Subscribe(const ResultCalculatedHandler& handler)
+    {
+        subscribers.push_back(handler);
+    }
+
+    void SubscribeBatch(const ResultBatchHandler& handler)
+    {
+        batchSubscribers.push_back(handler);
+    }
+
+    void PublishResult(double result, const std::string& operationName) const
+    {
+        for (const auto& subscriber : subscribers)
+        {
+            subscriber(result, operationName);
+        }
+
+        if (!batchSubscribers.empty())
+        {
+            const ResultRecord record{result, OperationRegistry::Intern(operationName)};
+            for (const auto& subscriber : batchSubscribers)
+            {
+                subscriber(std::span<const ResultRecord>(&record, 1));
+            }
+        }
+    }
+
+    void PublishResults(std::span<const ResultRecord> records) const
+    {
+        for (const auto& subscriber : batchSubscribers)
+        {
+            subscriber(records);
+        }
+
+        if (subscribers.empty())
+        {
+            return;
+        }
+
+        OperationNameLookup lookup;
+        for (const ResultRecord& record : records)
+        {
+            const std::string& operationName = lookup(record.operationId);
+            for (const auto& subscriber : subscribers)
+            {
+                subscriber(record.result, operationName);
+            }
+        }
+    }
+};
+
+void AppendNumber(std::string& output, double value)
+{
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, 6);
+    output.append(buffer, result.ptr);
+}
+
+class ConsoleLoggerObserver
+{
+public:
+    void OnResultCalculated(double result, const std::string& operationName) const
+    {
+        std::cout << "[consoleloggerobserver] operation=" << operationName
+                  << ", result=" << result << std::endl;
+    }
+
+    void OnResultsCalculated(std::span<const ResultRecord> records) const
+    {
+        OperationNameLookup lookup;
+        std::string text;
+        text.reserve(records.size() * 64);
+        for (const ResultRecord& record : records)
+        {
+            text += "[consoleloggerobserver] operation=";
+            text += lookup(record.operationId);
+            text += ", result=";
+            AppendNumber(text, record.result);
+            text += '\n';
+        }
+
+        std::cout.write(text.data(), static_cast<std::streamsize>(text.size()));
+        std::cout.flush();
+    }
+};
+
+class HistoryLoggerObserver
+{
+public:
+    struct HistoryRecord
+    {
+        double result;
+        std::int64_t timestamp;
+        OperationId operationId;
+    };
+
+    static_assert(sizeof(HistoryRecord) <= 24, "history records are meant to stay compact");
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Allocated once; once full, each new record overwrites the oldest one.
+    std::vector<HistoryRecord> records;
+    size_t next = 0;
+    std::uint64_t recordedCount = 0;
+    Clock::time_point createdAt = Clock::now();
+
+    void Record(double result, OperationId operationId)
+    {
+        records[next] = HistoryRecord{result, (Clock::now() - createdAt).count(), operationId};
+        next = next + 1 == records.size() ? 0 : next + 1;
+        ++recordedCount;
+    }
+
+    template <typename Visitor>
+    void ForEachRecord(Visitor&& visit) const
+    {
+        const size_t stored = GetSize();
+        size_t index = stored < records.size() ? 0 : next;
+        for (size_t i = 0; i < stored; ++i)
+        {
+            visit(records[index]);
+            index = index + 1 == records.size() ? 0 : index + 1;
+        }
+    }
+
+public:
+    explicit HistoryLoggerObserver(size_t capacity = 4096)
+        : records(std::max<size_t>(capacity, 1))
+    {
+    }
+
+    void OnResultCalculated(double result, const std::string& operationName)
+    {
+        Record(result, OperationRegistry::Intern(operationName));
+    }
+
+    void OnResultsCalculated(std::span<const ResultRecord> results)
+    {
+        for (const ResultRecord& result : results)
+        {
+            Record(result.result, result.operationId);
+        }
+    }
+
+    size_t GetSize() const
+    {
+        return static_cast<size_t>(std::min<std::uint64_t>(recordedCount, records.size()));
+    }
+
+    std::uint64_t GetOverwrittenCount() const
+    {
+        return recordedCount - GetSize();
+    }
+
+    void PrintHistory() const
+    {
+        std::cout << "\n[historyloggerobserver] stored history:" << std::endl;
+        if (GetOverwrittenCount() > 0)
+        {
+            std::cout << "(" << GetOverwrittenCount() << " older entries overwritten)" << std::endl;
+        }
+
+        OperationNameLookup lookup;
+        std::string text;
+        ForEachRecord(
+            [&text, &lookup](const HistoryRecord& record)
+            {
+                text += "- ";
+                text += lookup(record.operationId);
+                text += " -> ";
+                AppendNumber(text, record.result);
+                text += '\n';
+            });
+
+        std::cout.write(text.data(), static_cast<std::streamsize>(text.size()));
+        std::cout.flush();
+    }
+
+    // One "seconds,operation,result" line per stored record, oldest first; seconds are relative
+    // to the observer's creation.
+    // Returns false when the stream could not be written, e.g. a file that failed to open.
+    bool ExportCsv(std::ostream& output) const
+    {
+        OperationNameLookup lookup;
+        output << "seconds,operation,result\n";
+        ForEachRecord(
+            [&output, &lookup](const HistoryRecord& record)
+            {
+                const double seconds = std::chrono::duration<double>(Clock::duration(record.timestamp)).count();
+                std::string line;
+                AppendNumber(line, seconds);
+                line += ',';
+                line += lookup(record.operationId);
+                line += ',';
+                AppendNumber(line, record.result);
+                line += '\n';
+                output << line;
+            });
+
+        output.flush();
+        return static_cast<bool>(output);
+    }
+};
+
+class ThresholdNotifierObserver
+{
+private:
+    double threshold;
+
+public:
+    explicit ThresholdNotifierObserver(double thresholdValue)
+        : threshold(thresholdValue)
+    {
+    }
+
+    void OnResultCalculated(double result, const std::string& operationName) const
+    {
+        if (result > threshold)
+        {
+            std::cout << "[thresholdnotifierobserver] " << operationName
+                      << " result " << result
+                      << " is above threshold " << threshold << std::endl;
+        }
+    }
+
+    void OnResultsCalculated(std::span<const ResultRecord> records) const
+    {
+        OperationNameLookup lookup;
+        for (const ResultRecord& record : records)
+        {
+            if (record.result > threshold)
+            {
+                OnResultCalculated(record.result, lookup(record.operationId));
+            }
+        }
+    }
+};
+
+enum class ThresholdRuleKind
+{
+    Above,
+    Below,
+    Inside
+};
+
+struct ThresholdRule
+{
+    static constexpr OperationId AnyOperation = ~OperationId{0};
+
+    ThresholdRuleKind kind;
+    double low;
+    double high;
+    OperationId operationId = AnyOperation;
+
+    static ThresholdRule Above(double threshold, OperationId operationId = AnyOperation)
+    {
+        return ThresholdRule{ThresholdRuleKind::Above, threshold, threshold, operationId};
+    }
+
+    static ThresholdRule Below(double threshold, OperationId operationId = AnyOperation)
+    {
+        return ThresholdRule{ThresholdRuleKind::Below, threshold, threshold, operationId};
+    }
+
+    static ThresholdRule Inside(double low, double high, OperationId operationId = AnyOperation)
+    {
+        return ThresholdRule{ThresholdRuleKind::Inside, low, high, operationId};
+    }
+
+    bool Matches(double result) const
+    {
+        switch (kind)
+        {
+        case ThresholdRuleKind::Above:
+            return result > low;
+        case ThresholdRuleKind::Below:
+            return result < high;
+        default:
+            return low <= result && result <= high;
+        }
+    }
+};
+
+struct ThresholdNotification
+{
+    double result;
+    std::uint32_t ruleIndex;
+    OperationId operationId;
+};
+
+// Rules for one operation (or for all of them), indexed so a lookup costs O(log n + matches):
+// Above/Below thresholds are sorted and fire as a prefix/suffix, Inside intervals live in a
+// centered interval tree.
+class ThresholdRuleIndex
+{
+private:
+    struct SortedThreshold
+    {
+        double value;
+        std::uint32_t ruleIndex;
+    };
+
+    struct Interval
+    {
+        double low;
+        double high;
+        std::uint32_t ruleIndex;
+    };
+
+    struct IntervalNode
+    {
+        double center;
+        std::vector<Interval> byLow;
+        std::vector<Interval> byHigh;
+        int left = -1;
+        int right = -1;
+    };
+
+    std::vector<SortedThreshold> above;
+    std::vector<SortedThreshold> below;
+    std::vector<IntervalNode> nodes;
+    int root = -1;
+
+    double minIntervalLow = std::numeric_limits<double>::infinity();
+    double maxIntervalHigh = -std::numeric_limits<double>::infinity();
+
+    int BuildNode(std::vector<Interval> intervals)
+    {
+        if (intervals.empty())
+        {
+            return -1;
+        }
+
+        std::vector<double> endpoints;
+        endpoints.reserve(intervals.size() * 2);
+        for (const Interval& interval : intervals)
+        {
+            endpoints.push_back(interval.low);
+            endpoints.push_back(interval.high);
+        }
+        std::nth_element(endpoints.begin(), endpoints.begin() + static_cast<std::ptrdiff_t>(endpoints.size() / 2), endpoints.end());
+        const double center = endpoints[endpoints.size() / 2];
+
+        std::vector<Interval> leftIntervals;
+        std::vector<Interval> rightIntervals;
+        IntervalNode node;
+        node.center = center;
+        for (const Interval& interval : intervals)
+        {
+            if (interval.high < center)
+            {
+                leftIntervals.push_back(interval);
+            }
+            else if (interval.low > center)
+            {
+                rightIntervals.push_back(interval);
+            }
+            else
+            {
+                node.byLow.push_back(interval);
+            }
+        }
+
+        node.byHigh = node.byLow;
+        std::sort(node.byLow.begin(), node.byLow.end(), [](const Interval& a, const Interval& b) { return a.low < b.low; });
+        std::sort(node.byHigh.begin(), node.byHigh.end(), [](const Interval& a, const Interval& b) { return a.high > b.high; });
+
+        const int index = static_cast<int>(nodes.size());
+        nodes.push_back(std::move(node));
+        const int leftChild = BuildNode(std::move(leftIntervals));
+        const int rightChild = BuildNode(std::move(rightIntervals));
+        nodes[static_cast<size_t>(index)].left = leftChild;
+        nodes[static_cast<size_t>(index)].right = rightChild;
+        return index;
+    }
+
+public:
+    void Build(const std::vector<ThresholdRule>& rules, OperationId operationId)
+    {
+        above.clear();
+        below.clear();
+        nodes.clear();
+        minIntervalLow = std::numeric_limits<double>::infinity();
+        maxIntervalHigh = -std::numeric_limits<double>::infinity();
+
+        std::vector<Interval> intervals;
+        for (size_t i = 0; i < rules.size(); ++i)
+        {
+            const ThresholdRule& rule = rules[i];
+            if (rule.operationId != operationId)
+            {
+                continue;
+            }
+
+            const auto ruleIndex = static_cast<std::uint32_t>(i);
+            if (rule.kind == ThresholdRuleKind::Above)
+            {
+                above.push_back(SortedThreshold{rule.low, ruleIndex});
+            }
+            else if (rule.kind == ThresholdRuleKind::Below)
+            {
+                below.push_back(SortedThreshold{rule.high, ruleIndex});
+            }
+            else if (rule.low <= rule.high)
+            {
+                intervals.push_back(Interval{rule.low, rule.high, ruleIndex});
+                minIntervalLow = std::min(minIntervalLow, rule.low);
+                maxIntervalHigh = std::max(maxIntervalHigh, rule.high);
+            }
+        }
+
+        const auto byValue = [](const SortedThreshold& a, const SortedThreshold& b) { return a.value < b.value; };
+        std::sort(above.begin(), above.end(), byValue);
+        std::sort(below.begin(), below.end(), byValue);
+        root = BuildNode(std::move(intervals));
+    }
+
+    bool IsEmpty() const
+    {
+        return above.empty() && below.empty() && root < 0;
+    }
+
+    // Results in [GetQuietLow(), GetQuietHigh()] cannot trip an Above or Below rule.
+    double GetQuietLow() const
+    {
+        return below.empty() ? -std::numeric_limits<double>::infinity() : below.back().value;
+    }
+
+    double GetQuietHigh() const
+    {
+        return above.empty() ? std::numeric_limits<double>::infinity() : above.front().value;
+    }
+
+    double GetMinIntervalLow() const { return minIntervalLow; }
+    double GetMaxIntervalHigh() const { return maxIntervalHigh; }
+
+    void Collect(double result, OperationId operationId, std::vector<ThresholdNotification>& notifications) const
+    {
+        if (std::isnan(result))
+        {
+            return;
+        }
+
+        const auto fired = [&notifications, result, operationId](std::uint32_t ruleIndex)
+        {
+            notifications.push_back(ThresholdNotification{result, ruleIndex, operationId});
+        };
+
+        const auto valueBelow = [](const SortedThreshold& threshold, double value) { return threshold.value < value; };
+        const auto firstNotBelow = std::lower_bound(above.begin(), above.end(), result, valueBelow);
+        for (auto it = above.begin(); it != firstNotBelow; ++it)
+        {
+            fired(it->ruleIndex);
+        }
+
+        const auto valueAbove = [](double value, const SortedThreshold& threshold) { return value < threshold.value; };
+        for (auto it = std::upper_bound(below.begin(), below.end(), result, valueAbove); it != below.end(); ++it)
+        {
+            fired(it->ruleIndex);
+        }
+
+        for (int current = root; current >= 0;)
+        {
+            const IntervalNode& node = nodes[static_cast<size_t>(current)];
+            if (result < node.center)
+            {
+                for (const Interval& interval : node.byLow)
+                {
+                    if (interval.low > result)
+                    {
+                        break;
+                    }
+                    fired(interval.ruleIndex);
+                }
+                current = node.left;
+            }
+            else
+            {
+                for (const Interval& interval : node.byHigh)
+                {
+                    if (interval.high < result)
+                    {
+                        break;
+                    }
+                    fired(interval.ruleIndex);
+                }
+                current = result > node.center ? node.right : -1;
+            }
+        }
+    }
+};
+
+class MultiThresholdNotifierObserver
+{
+public:
+    using NotificationHandler = std::function<void(std::span<const ThresholdNotification>)>;
+
+private:
+    static constexpr size_t ChunkSize = 1024;
+
+    std::vector<ThresholdRule> rules;
+    std::unordered_map<OperationId, ThresholdRuleIndex> indexes;
+    ThresholdRuleIndex anyOperationIndex;
+    bool indexDirty = false;
+    NotificationHandler handler;
+
+    std::vector<ThresholdNotification> notifications;
+    std::vector<double> chunkValues;
+    std::vector<std::uint32_t> candidates;
+
+    void RebuildIndex()
+    {
+        indexes.clear();
+        anyOperationIndex.Build(rules, ThresholdRule::AnyOperation);
+        for (const ThresholdRule& rule : rules)
+        {
+            if (rule.operationId != ThresholdRule::AnyOperation && indexes.count(rule.operationId) == 0)
+            {
+                indexes[rule.operationId].Build(rules, rule.operationId);
+            }
+        }
+
+        indexDirty = false;
+    }
+
+    void EvaluateGroup(std::span<const ResultRecord> group)
+    {
+        const OperationId operationId = group.front().operationId;
+        const auto found = indexes.find(operationId);
+        const ThresholdRuleIndex* own = found != indexes.end() ? &found->second : nullptr;
+        if (own == nullptr && anyOperationIndex.IsEmpty())
+        {
+            return;
+        }
+
+        double quietLow = anyOperationIndex.GetQuietLow();
+        double quietHigh = anyOperationIndex.GetQuietHigh();
+        double hotLow = anyOperationIndex.GetMinIntervalLow();
+        double hotHigh = anyOperationIndex.GetMaxIntervalHigh();
+        if (own != nullptr)
+        {
+            quietLow = std::max(quietLow, own->GetQuietLow());
+            quietHigh = std::min(quietHigh, own->GetQuietHigh());
+            hotLow = std::min(hotLow, own->GetMinIntervalLow());
+            hotHigh = std::max(hotHigh, own->GetMaxIntervalHigh());
+        }
+
+        for (size_t offset = 0; offset < group.size(); offset += ChunkSize)
+        {
+            const size_t size = std::min(ChunkSize, group.size() - offset);
+            for (size_t i = 0; i < size; ++i)
+            {
+                chunkValues[i] = group[offset + i].result;
+            }
+
+            const size_t selected = NumericKernels::SelectCandidates(chunkValues.data(), size, quietLow, quietHigh,
+                                                                     hotLow, hotHigh, candidates.data());
+            for (size_t i = 0; i < selected; ++i)
+            {
+                const double result = chunkValues[candidates[i]];
+                if (own != nullptr)
+                {
+                    own->Collect(result, operationId, notifications);
+                }
+                anyOperationIndex.Collect(result, operationId, notifications);
+            }
+        }
+    }
+
+public:
+    explicit MultiThresholdNotifierObserver(NotificationHandler notificationHandler = nullptr)
+        : handler(std::move(notificationHandler)), chunkValues(ChunkSize), candidates(ChunkSize)
+    {
+        if (!handler)
+        {
+            handler = [this](std::span<const ThresholdNotification> fired) { PrintNotifications(fired); };
+        }
+    }
+
+    MultiThresholdNotifierObserver(const MultiThresholdNotifierObserver&) = delete;
+    MultiThresholdNotifierObserver& operator=(const MultiThresholdNotifierObserver&) = delete;
+
+    size_t AddRule(const ThresholdRule& rule)
+    {
+        rules.push_back(rule);
+        indexDirty = true;
+        return rules.size() - 1;
+    }
+
+    const ThresholdRule& GetRule(size_t ruleIndex) const
+    {
+        return rules.at(ruleIndex);
+    }
+
+    size_t GetRuleCount() const
+    {
+        return rules.size();
+    }
+
+    void OnResultCalculated(double result, const std::string& operationName)
+    {
+        const ResultRecord record{result, OperationRegistry::Intern(operationName)};
+        OnResultsCalculated(std::span<const ResultRecord>(&record, 1));
+    }
+
+    void OnResultsCalculated(std::span<const ResultRecord> records)
+    {
+        if (indexDirty)
+        {
+            RebuildIndex();
+        }
+
+        notifications.clear();
+        size_t groupStart = 0;
+        for (size_t i = 1; i <= records.size(); ++i)
+        {
+            if (i == records.size() || records[i].operationId != records[groupStart].operationId)
+            {
+                EvaluateGroup(records.subspan(groupStart, i - groupStart));
+                groupStart = i;
+            }
+        }
+
+        if (!notifications.empty())
+        {
+            handler(notifications);
+        }
+    }
+
+    void PrintNotifications(std::span<const ThresholdNotification> fired) const
+    {
+        OperationNameLookup lookup;
+        std::string text;
+        for (const ThresholdNotification& notification : fired)
+        {
+            const ThresholdRule& rule = rules[notification.ruleIndex];
+            text += "[multithresholdnotifierobserver] ";
+            text += lookup(notification.operationId);
+            text += " result ";
+            AppendNumber(text, notification.result);
+            if (rule.kind == ThresholdRuleKind::Above)
+            {
+                text += " is above ";
+                AppendNumber(text, rule.low);
+            }
+            else if (rule.kind == ThresholdRuleKind::Below)
+            {
+                text += " is below ";
+                AppendNumber(text, rule.high);
+            }
+            else
+            {
+                text += " is inside [";
+                AppendNumber(text, rule.low);
+                text += ", ";
+                AppendNumber(text, rule.high);
+                text += ']';
+            }
+            text += " (rule " + std::to_string(notification.ruleIndex) + ")\n";
+        }
+
+        std::cout.write(text.data(), static_cast<std::streamsize>(text.size()));
+        std::cout.flush();
+    }
+};
+
+void ProcessAndPublishResult(
+    NumericProcessor& processor,
+    const ResultPublisher& publisher,
+    double value)
+{
+    const double result = processor.Process(value);
+    const std::string operationName = processor.GetCurrentOperationName();
+
+    publisher.PublishResult(result, operationName);
+}
+
+// Results are published in chunks that fit in cache, so observers see thousands of records per call
+// without the batch needing memory proportional to the input.
+void ProcessAndPublishBatch(
+    NumericProcessor& processor,
+    const ResultPublisher& publisher,
+    std::span<const double> values)
+{
+    constexpr size_t ChunkSize = 4096;
+    const OperationId operationId = OperationRegistry::Intern(processor.GetCurrentOperationName());
+
+    std::vector<double> results(std::min(values.size(), ChunkSize));
+    std::vector<ResultRecord> records(results.size());
+    for (size_t offset = 0; offset < values.size(); offset += ChunkSize)
+    {
+        const size_t size = std::min(ChunkSize, values.size() - offset);
+        processor.ProcessBatch(values.subspan(offset, size), results);
+        for (size_t i = 0; i < size; ++i)
+        {
+            records[i] = ResultRecord{results[i], operationId};
+        }
+
+        publisher.PublishResults(std::span<const ResultRecord>(records.data(), size));
+    }
+}
+
+enum class PublishOrder
+{
+    Ordered,
+    Unordered
+};
+
+// Ordered runs the input in windows of a few chunks per thread and publishes each window in input order,
+// so memory stays bounded and observers see the same sequence as ProcessAndPublishBatch. Unordered lets
+// every worker publish its chunk from a per-thread buffer as soon as it is done; publish calls are
+// serialised, so observers never run concurrently, but chunk order is arbitrary. If a strategy throws,
+// the exception is rethrown after the current window (or, unordered, after all chunks) finished.
+void ProcessAndPublishParallel(
+    NumericProcessor& processor,
+    const ResultPublisher& publisher,
+    std::span<const double> values,
+    WorkStealingPool& pool,
+    PublishOrder order)
+{
+    static constexpr size_t ChunkSize = 4096;
+    const OperationId operationId = OperationRegistry::Intern(processor.GetCurrentOperationName());
+    const size_t chunkCount = (values.size() + ChunkSize - 1) / ChunkSize;
+
+    const auto processChunk = [&processor, values, operationId](size_t chunk, std::vector<double>& results,
+                                                                 std::span<ResultRecord> records)
+    {
+        const size_t offset = chunk * ChunkSize;
+        const size_t size = std::min(ChunkSize, values.size() - offset);
+        results.resize(size);
+        processor.ProcessBatch(values.subspan(offset, size), results);
+        for (size_t i = 0; i < size; ++i)
+        {
+            records[i] = ResultRecord{results[i], operationId};
+        }
+        return size;
+    };
+
+    if (order == PublishOrder::Unordered)
+    {
+        std::mutex publishMutex;
+        pool.ParallelFor(chunkCount, [&](size_t chunk)
+        {
+            static thread_local std::vector<double> results;
+            static thread_local std::vector<ResultRecord> records;
+            records.resize(ChunkSize);
+
+            const size_t size = processChunk(chunk, results, records);
+            std::lock_guard<std::mutex> lock(publishMutex);
+            publisher.PublishResults(std::span<const ResultRecord>(records.data(), size));
+        });
+        return;
+    }
+
+    const size_t windowChunks = pool.GetThreadCount() * 4;
+    std::vector<ResultRecord> window(windowChunks * ChunkSize);
+    for (size_t firstChunk = 0; firstChunk < chunkCount; firstChunk += windowChunks)
+    {
+        const size_t chunks = std::min(windowChunks, chunkCount - firstChunk);
+        pool.ParallelFor(chunks, [&](size_t chunk)
+        {
+            static thread_local std::vector<double> results;
+            processChunk(firstChunk + chunk, results, std::span<ResultRecord>(window).subspan(chunk * ChunkSize, ChunkSize));
+        });
+
+        const size_t windowSize = std::min(chunks * ChunkSize, values.size() - firstChunk * ChunkSize);
+        publisher.PublishResults(std::span<const ResultRecord>(window.data(), windowSize));
+    }
+}
+
+int RunBatchBenchmark(size_t count)
+{
+    using Clock = std::chrono::steady_clock;
+
+    SquareOperationStrategy squareStrategy;
+    CubeOperationStrategy cubeStrategy;
+    SquareRootOperationStrategy squareRootStrategy;
+    const INumericOperationStrategy* strategies[] = {&squareStrategy, &cubeStrategy, &squareRootStrategy};
+
+    std::vector<double> input(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        input[i] = static_cast<double>(i % 1000) * 0.5;
+    }
+    std::vector<double> perValue(count);
+    std::vector<double> batched(count);
+
+    bool allMatch = true;
+    for (const INumericOperationStrategy* strategy : strategies)
+    {
+        NumericProcessor processor(strategy);
+
+        auto start = Clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            perValue[i] = processor.Process(input[i]);
+        }
+        const double perValueSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        start = Clock::now();
+        processor.ProcessBatch(input, batched);
+        const double batchSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        const bool match = perValue == batched;
+        allMatch = allMatch && match;
+
+        const double gigabytes = static_cast<double>(count) * 2 * sizeof(double) / 1e9;
+        std::cout << std::fixed << std::setprecision(2) << std::setw(10) << std::left << strategy->GetOperationName()
+                  << std::right << " per value: " << std::setw(6) << perValueSeconds * 1e9 / static_cast<double>(count)
+                  << " ns/value, batch: " << std::setw(6) << batchSeconds * 1e9 / static_cast<double>(count)
+                  << " ns/value (" << gigabytes / batchSeconds << " GB/s), results match=" << (match ? "yes" : "no")
+                  << std::endl;
+    }
+
+    // Square, add one, take the root: staged runs three whole-array passes, fused runs one.
+    const auto plusOne = MakeOperationStage("plusone", [](double value) { return value + 1.0; });
+    const auto fusedStrategy = ComposeOperations(squareStrategy, plusOne, squareRootStrategy);
+    const auto plusOneStrategy = ComposeOperations(plusOne);
+    NumericProcessor processor(&squareStrategy);
+
+    auto start = Clock::now();
+    processor.ProcessBatch(input, perValue);
+    processor.SetStrategy(&plusOneStrategy);
+    processor.ProcessBatch(perValue, perValue);
+    processor.SetStrategy(&squareRootStrategy);
+    processor.ProcessBatch(perValue, perValue);
+    const double stagedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    processor.SetStrategy(&fusedStrategy);
+    start = Clock::now();
+    processor.ProcessBatch(input, batched);
+    const double fusedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const bool fusedMatch = perValue == batched;
+    allMatch = allMatch && fusedMatch;
+    std::cout << fusedStrategy.GetOperationName() << " staged: " << stagedSeconds * 1e9 / static_cast<double>(count)
+              << " ns/value, fused: " << fusedSeconds * 1e9 / static_cast<double>(count)
+              << " ns/value, results match=" << (fusedMatch ? "yes" : "no") << std::endl;
+
+    // The parenthesised constant folds at parse time, leaving load, square, add-immediate and root.
+    const ExpressionOperationStrategy expressionStrategy("sqrt(x^2 + (2*3 - 5))");
+    std::vector<double> treeWalked(count);
+
+    start = Clock::now();
+    for (size_t i = 0; i < count; ++i)
+    {
+        treeWalked[i] = expressionStrategy.EvaluateTree(input[i]);
+    }
+    const double treeSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    processor.SetStrategy(&expressionStrategy);
+    start = Clock::now();
+    for (size_t i = 0; i < count; ++i)
+    {
+        perValue[i] = processor.Process(input[i]);
+    }
+    const double bytecodeSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    start = Clock::now();
+    processor.ProcessBatch(input, batched);
+    const double bytecodeBatchSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const bool expressionMatch = treeWalked == perValue && treeWalked == batched;
+    allMatch = allMatch && expressionMatch;
+    std::cout << expressionStrategy.GetOperationName() << " (" << expressionStrategy.GetInstructionCount()
+              << " instructions) tree walk: " << treeSeconds * 1e9 / static_cast<double>(count)
+              << " ns/value, bytecode per value: " << bytecodeSeconds * 1e9 / static_cast<double>(count)
+              << " ns/value, bytecode batch: " << bytecodeBatchSeconds * 1e9 / static_cast<double>(count)
+              << " ns/value, results match=" << (expressionMatch ? "yes" : "no") << std::endl;
+
+    double perValueSum = 0.0;
+    ResultPublisher perValuePublisher;
+    perValuePublisher.Subscribe([&perValueSum](double result, const std::string&) { perValueSum += result; });
+
+    double batchSum = 0.0;
+    ResultPublisher batchPublisher;
+    batchPublisher.SubscribeBatch(
+        [&batchSum](std::span<const ResultRecord> records)
+        {
+            for (const ResultRecord& record : records)
+            {
+                batchSum += record.result;
+            }
+        });
+
+    processor.SetStrategy(&squareStrategy);
+    const size_t publishCount = std::min<size_t>(count, 1000000);
+    const std::span<const double> publishInput(input.data(), publishCount);
+
+    start = Clock::now();
+    for (const double value : publishInput)
+    {
+        ProcessAndPublishResult(processor, perValuePublisher, value);
+    }
+    const double perValuePublishSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    start = Clock::now();
+    ProcessAndPublishBatch(processor, batchPublisher, publishInput);
+    const double batchPublishSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const bool publishMatch = perValueSum == batchSum;
+    allMatch = allMatch && publishMatch;
+    std::cout << "publish " << publishCount << " results, per value: "
+              << perValuePublishSeconds * 1e9 / static_cast<double>(publishCount)
+              << " ns/result, batch: " << batchPublishSeconds * 1e9 / static_cast<double>(publishCount)
+              << " ns/result, sums match=" << (publishMatch ? "yes" : "no") << std::endl;
+
+    // 500 alert rules against results that mostly sit in the quiet band.
+    size_t indexedFired = 0;
+    MultiThresholdNotifierObserver notifier(
+        [&indexedFired](std::span<const ThresholdNotification> fired) { indexedFired += fired.size(); });
+    const OperationId squareId = OperationRegistry::Intern(squareStrategy.GetOperationName());
+    for (int rule = 0; rule < 200; ++rule)
+    {
+        notifier.AddRule(ThresholdRule::Above(250000.0 + rule * 10.0, squareId));
+        notifier.AddRule(ThresholdRule::Below(-1.0 - rule));
+        notifier.AddRule(rule % 2 == 0 ? ThresholdRule::Inside(100000.0 + rule * 50.0, 100010.0 + rule * 50.0, squareId)
+                                       : ThresholdRule::Inside(1e9 + rule, 1e9 + rule + 5.0));
+    }
+
+    std::vector<ResultRecord> alertRecords(publishCount);
+    for (size_t i = 0; i < publishCount; ++i)
+    {
+        alertRecords[i] = ResultRecord{input[i] * input[i], squareId};
+    }
+
+    size_t linearFired = 0;
+    start = Clock::now();
+    for (const ResultRecord& record : alertRecords)
+    {
+        for (size_t rule = 0; rule < notifier.GetRuleCount(); ++rule)
+        {
+            const ThresholdRule& candidate = notifier.GetRule(rule);
+            if ((candidate.operationId == ThresholdRule::AnyOperation || candidate.operationId == record.operationId) &&
+                candidate.Matches(record.result))
+            {
+                ++linearFired;
+            }
+        }
+    }
+    const double linearSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    start = Clock::now();
+    for (size_t offset = 0; offset < alertRecords.size(); offset += 4096)
+    {
+        notifier.OnResultsCalculated(
+            std::span<const ResultRecord>(alertRecords).subspan(offset, std::min<size_t>(4096, alertRecords.size() - offset)));
+    }
+    const double indexedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const bool alertsMatch = linearFired == indexedFired;
+    allMatch = allMatch && alertsMatch;
+    std::cout << notifier.GetRuleCount() << " threshold rules, " << indexedFired << " notifications, linear scan: "
+              << linearSeconds * 1e9 / static_cast<double>(publishCount) << " ns/result, indexed batch: "
+              << indexedSeconds * 1e9 / static_cast<double>(publishCount)
+              << " ns/result, counts match=" << (alertsMatch ? "yes" : "no") << std::endl;
+
+    WorkStealingPool pool(std::max(2u, std::thread::hardware_concurrency()));
+    processor.SetStrategy(&cubeStrategy);
+    for (const PublishOrder order : {PublishOrder::Ordered, PublishOrder::Unordered})
+    {
+        double parallelSum = 0.0;
+        size_t parallelCount = 0;
+        ResultPublisher parallelPublisher;
+        parallelPublisher.SubscribeBatch(
+            [&parallelSum, &parallelCount](std::span<const ResultRecord> records)
+            {
+                for (const ResultRecord& record : records)
+                {
+                    parallelSum += record.result;
+                }
+                parallelCount += records.size();
+            });
+
+        start = Clock::now();
+        ProcessAndPublishParallel(processor, parallelPublisher, input, pool, order);
+        const double parallelSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        const bool parallelMatch = parallelCount == count;
+        allMatch = allMatch && parallelMatch;
+        std::cout << "parallel " << (order == PublishOrder::Ordered ? "ordered" : "unordered") << " on "
+                  << pool.GetThreadCount() << " threads: " << parallelSeconds * 1e9 / static_cast<double>(count)
+                  << " ns/result, all published=" << (parallelMatch ? "yes" : "no") << std::endl;
+    }
+
+    // An expensive formula over inputs that repeat every 1000 values.
+    const ExpressionOperationStrategy expensiveStrategy("exp(sin(x)) * log(x + 1) + pow(x, 1.5)");
+    const CachingOperationStrategy cachingStrategy(&expensiveStrategy);
+    processor.SetStrategy(&expensiveStrategy);
+
+    start = Clock::now();
+    processor.ProcessBatch(input, perValue);
+    const double uncachedSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    processor.SetStrategy(&cachingStrategy);
+    start = Clock::now();
+    for (size_t i = 0; i < count; ++i)
+    {
+        batched[i] = processor.Process(input[i]);
+    }
+    const double cachedPerValueSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    bool cacheMatch = perValue == batched;
+
+    start = Clock::now();
+    processor.ProcessBatch(input, batched);
+    const double cachedBatchSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    cacheMatch = cacheMatch && perValue == batched;
+
+    const ConcurrentCachingOperationStrategy concurrentCachingStrategy(&expensiveStrategy);
+    processor.SetStrategy(&concurrentCachingStrategy);
+    start = Clock::now();
+    processor.ProcessBatchParallel(input, batched, pool);
+    const double concurrentSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    cacheMatch = cacheMatch && perValue == batched;
+
+    allMatch = allMatch && cacheMatch;
+    const auto hitRate = [](std::uint64_t hits, std::uint64_t misses)
+    {
+        return 100.0 * static_cast<double>(hits) / static_cast<double>(std::max<std::uint64_t>(1, hits + misses));
+    };
+    std::cout << "cached " << expensiveStrategy.GetOperationName() << " uncached batch: "
+              << uncachedSeconds * 1e9 / static_cast<double>(count)
+              << " ns/value, cached per value: " << cachedPerValueSeconds * 1e9 / static_cast<double>(count)
+              << " ns/value, cached batch: " << cachedBatchSeconds * 1e9 / static_cast<double>(count) << " ns/value ("
+              << hitRate(cachingStrategy.GetHitCount(), cachingStrategy.GetMissCount()) << "% hits), striped on "
+              << pool.GetThreadCount() << " threads: " << concurrentSeconds * 1e9 / static_cast<double>(count)
+              << " ns/value (" << hitRate(concurrentCachingStrategy.GetHitCount(), concurrentCachingStrategy.GetMissCount())
+              << "% hits), results match=" << (cacheMatch ? "yes" : "no") << std::endl;
+
+    return allMatch ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc >= 2 && std::string(argv[1]) == "bench")
+    {
+        return RunBatchBenchmark(argc >= 3 ? static_cast<size_t>(std::stod(argv[2])) : 10000000);
+    }
+
+    SquareOperationStrategy squareStrategy;
+    CubeOperationStrategy cubeStrategy;
+    SquareRootOperationStrategy squareRootStrategy;
+
+    NumericProcessor processor(&squareStrategy);
+    ResultPublisher publisher;
+
+    ConsoleLoggerObserver consoleLogger;
+    HistoryLoggerObserver historyLogger;
+    ThresholdNotifierObserver thresholdNotifier(50.0);
+
+    publisher.SubscribeBatch(
+        [&consoleLogger](std::span<const ResultRecord> records)
+        {
+            consoleLogger.OnResultsCalculated(records);
+        });
+
+    publisher.SubscribeBatch(
+        [&historyLogger](std::span<const ResultRecord> records)
+        {
+            historyLogger.OnResultsCalculated(records);
+        });
+
+    publisher.SubscribeBatch(
+        [&thresholdNotifier](std::span<const ResultRecord> records)
+        {
+            thresholdNotifier.OnResultsCalculated(records);
+        });
+
+    MultiThresholdNotifierObserver multiThresholdNotifier;
+    multiThresholdNotifier.AddRule(ThresholdRule::Above(100.0, OperationRegistry::Intern(cubeStrategy.GetOperationName())));
+    multiThresholdNotifier.AddRule(ThresholdRule::Inside(10.0, 12.5));
+    multiThresholdNotifier.AddRule(ThresholdRule::Below(5.0));
+    publisher.SubscribeBatch(
+        [&multiThresholdNotifier](std::span<const ResultRecord> records)
+        {
+            multiThresholdNotifier.OnResultsCalculated(records);
+        });
+
+    std::cout << "=== strategy + observer demo ===" << std::endl;
+
+    processor.SetStrategy(&squareStrategy);
+    ProcessAndPublishResult(processor, publisher, 4.0);
+    ProcessAndPublishResult(processor, publisher, 8.0);
+
+    processor.SetStrategy(&cubeStrategy);
     ProcessAndPublishResult(processor, publisher, 3.0);
     ProcessAndPublishResult(processor, publisher, 5.0);
 
@@ -223,5 +3063,86 @@ int main()
     ProcessAndPublishResult(processor, publisher, 81.0);
     ProcessAndPublishResult(processor, publisher, 144.0);
 
+    std::cout << "\n=== batch processing ===" << std::endl;
+    const std::vector<double> batchValues = {2.0, 9.0, 16.0, 100.0};
+    processor.SetStrategy(&squareStrategy);
+    ProcessAndPublishBatch(processor, publisher, batchValues);
+
+    std::cout << "\n=== fused pipeline ===" << std::endl;
+    const auto hypotenuseStrategy = ComposeOperations(
+        squareStrategy, MakeOperationStage("plusnine", [](double value) { return value + 9.0; }), squareRootStrategy);
+    processor.SetStrategy(&hypotenuseStrategy);
+    ProcessAndPublishResult(processor, publisher, 4.0);
+
+    // A formula can come from the command line (lab24 expr "<formula>") instead of being compiled in.
+    std::cout << "\n=== runtime expression ===" << std::endl;
+    const std::string formula = argc >= 3 && std::string(argv[1]) == "expr" ? argv[2] : "sqrt(x*x + 1)";
+    try
+    {
+        const ExpressionOperationStrategy expressionStrategy(formula);
+        processor.SetStrategy(&expressionStrategy);
+        ProcessAndPublishBatch(processor, publisher, batchValues);
+    }
+    catch (const std::invalid_argument& error)
+    {
+        std::cout << "Invalid formula: " << error.what() << std::endl;
+    }
+
+    // Operator chains of any length compile; only nesting deeper than MaxDepth and trees over
+    // MaxNodes are rejected.
+    std::string flatSum = "x";
+    for (int i = 1; i < 100000; ++i)
+    {
+        flatSum += "+x";
+    }
+    std::string oversizedSum = "x";
+    for (size_t i = 1; i <= ExpressionOperationStrategy::MaxNodes / 2; ++i)
+    {
+        oversizedSum += "+x";
+    }
+    const std::pair<const char*, std::string> largeFormulas[] = {
+        {"100000-term flat sum", flatSum},
+        {"1000000 nested parentheses", std::string(1000000, '(') + "x" + std::string(1000000, ')')},
+        {"1000000 unary minuses", std::string(1000000, '-') + "x"},
+        {"flat sum over the node limit", oversizedSum}};
+    for (const auto& [description, largeFormula] : largeFormulas)
+    {
+        try
+        {
+            const ExpressionOperationStrategy accepted(largeFormula);
+            std::cout << description << ": accepted with " << accepted.GetInstructionCount()
+                      << " instructions, at x=1 gives " << accepted.Execute(1.0) << std::endl;
+        }
+        catch (const std::invalid_argument& error)
+        {
+            std::cout << description << ": rejected, " << error.what() << std::endl;
+        }
+    }
+
+    std::cout << "\n=== cached strategy ===" << std::endl;
+    const CachingOperationStrategy cachedCubeStrategy(&cubeStrategy, 64);
+    processor.SetStrategy(&cachedCubeStrategy);
+    for (const double value : {3.0, 5.0, 3.0, 3.0})
+    {
+        ProcessAndPublishResult(processor, publisher, value);
+    }
+    std::cout << "cache hits: " << cachedCubeStrategy.GetHitCount() << ", misses: " << cachedCubeStrategy.GetMissCount()
+              << std::endl;
+
     historyLogger.PrintHistory();
+
+    // The history is written to disk only on request: lab24 [expr "<formula>"] --history <file.csv>.
+    for (int i = 1; i + 1 < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--history")
+        {
+            std::ofstream historyFile(argv[i + 1]);
+            if (!historyFile.is_open() || !historyLogger.ExportCsv(historyFile))
+            {
+                std::cerr << "could not write history to " << argv[i + 1] << std::endl;
+                return 1;
+            }
+            std::cout << "history exported to " << argv[i + 1] << std::endl;
+        }
+    }
 }
\ No newline at end of file
@@ -1,252 +1,2792 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <condition_variable>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
 #include <fstream>
 #include <functional>
+#include <iomanip>
 #include <iostream>
+#include <istream>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <span>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
-class ILogger
+class LogFormat
 {
-public:
-    virtual ~ILogger() = default;
-    virtual void Log(const std::string& message) = 0;
-};
+private:
+    std::uint16_t id;
+    const char* pattern;
+
+    static std::mutex& RegistryMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::vector<const char*>& Registry()
+    {
+        static std::vector<const char*> patterns;
+        return patterns;
+    }
 
-class ConsoleLogger : public ILogger
-{
 public:
-    void Log(const std::string& message) override
+    explicit LogFormat(const char* formatPattern)
+        : pattern(formatPattern)
+    {
+        std::lock_guard<std::mutex> lock(RegistryMutex());
+        id = static_cast<std::uint16_t>(Registry().size());
+        Registry().push_back(formatPattern);
+    }
+
+    std::uint16_t GetId() const { return id; }
+    const char* GetPattern() const { return pattern; }
+
+    static const char* Lookup(std::uint16_t formatId)
+    {
+        std::lock_guard<std::mutex> lock(RegistryMutex());
+        return formatId < Registry().size() ? Registry()[formatId] : nullptr;
+    }
+
+    static const LogFormat& Text()
     {
-        std::cout << "[consolelogger] " << message << std::endl;
+        static const LogFormat text("{}");
+        return text;
     }
 };
 
-class FileLogger : public ILogger
+enum class LogLevel : std::uint8_t
+{
+    Debug = 0,
+    Info = 1,
+    Warning = 2,
+    Error = 3
+};
+
+#ifndef LAB25_MIN_LOG_LEVEL
+#define LAB25_MIN_LOG_LEVEL 0
+#endif
+
+constexpr LogLevel CompiledMinLogLevel = static_cast<LogLevel>(LAB25_MIN_LOG_LEVEL);
+
+class LogRateLimiter
 {
 private:
-    std::string filePath;
+    const std::uint32_t maxMessages;
+    const std::int64_t intervalTicks;
+    std::atomic<std::int64_t> windowStart{0};
+    std::atomic<std::uint32_t> windowCount{0};
+    std::atomic<std::uint64_t> suppressed{0};
 
 public:
-    explicit FileLogger(const std::string& path)
-        : filePath(path)
+    LogRateLimiter(std::uint32_t maxMessagesPerInterval, std::chrono::steady_clock::duration interval)
+        : maxMessages(maxMessagesPerInterval), intervalTicks(interval.count())
     {
     }
 
-    void Log(const std::string& message) override
+    bool TryAcquire()
     {
-        std::ofstream output(filePath, std::ios::app);
+        const std::int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+        std::int64_t start = windowStart.load(std::memory_order_relaxed);
+        if (now - start >= intervalTicks && windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed))
+        {
+            windowCount.store(0, std::memory_order_relaxed);
+        }
 
-        if (output.is_open())
+        if (windowCount.fetch_add(1, std::memory_order_relaxed) < maxMessages)
         {
-            output << "[filelogger] " << message << std::endl;
+            return true;
         }
+
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    std::uint64_t GetSuppressedCount() const
+    {
+        return suppressed.load(std::memory_order_relaxed);
     }
 };
 
-class LoggerFactory
+enum class LogArgumentTag : std::uint8_t
 {
-public:
-    virtual ~LoggerFactory() = default;
-    virtual std::unique_ptr<ILogger> CreateLogger() const = 0;
+    Integer = 1,
+    Real = 2,
+    Text = 3
 };
 
-class ConsoleLoggerFactory : public LoggerFactory
+// Encodes a record into an inline buffer; a record that outgrows it moves to the heap, so no argument is cut.
+class LogRecordWriter
 {
 public:
-    std::unique_ptr<ILogger> CreateLogger() const override
+    static constexpr size_t InlineRecordLength = 240;
+
+private:
+    char inlineData[InlineRecordLength];
+    std::unique_ptr<char[]> overflow;
+    char* data = inlineData;
+    size_t capacity = InlineRecordLength;
+    size_t size = 0;
+
+    void Reserve(size_t bytes)
     {
-        return std::make_unique<ConsoleLogger>();
+        if (size + bytes <= capacity)
+        {
+            return;
+        }
+
+        const size_t grownCapacity = std::max(capacity * 2, size + bytes);
+        auto grown = std::make_unique<char[]>(grownCapacity);
+        std::memcpy(grown.get(), data, size);
+        overflow = std::move(grown);
+        data = overflow.get();
+        capacity = grownCapacity;
+    }
+
+    void Append(const void* bytes, size_t count)
+    {
+        std::memcpy(data + size, bytes, count);
+        size += count;
     }
-};
 
-class FileLoggerFactory : public LoggerFactory
-{
 public:
-    std::unique_ptr<ILogger> CreateLogger() const override
+    explicit LogRecordWriter(std::uint16_t formatId)
     {
-        return std::make_unique<FileLogger>("lab25_log.txt");
+        Append(&formatId, sizeof(formatId));
     }
-};
 
-class LoggerManager
-{
-private:
-    static LoggerManager* instance;
-    std::unique_ptr<LoggerFactory> factory;
+    LogRecordWriter(const LogRecordWriter&) = delete;
+    LogRecordWriter& operator=(const LogRecordWriter&) = delete;
 
-    LoggerManager()
-        : factory(std::make_unique<ConsoleLoggerFactory>())
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    void Write(T value)
     {
+        const auto widened = static_cast<std::int64_t>(value);
+        const auto tag = LogArgumentTag::Integer;
+        Reserve(1 + sizeof(widened));
+        Append(&tag, 1);
+        Append(&widened, sizeof(widened));
     }
 
-public:
-    LoggerManager(const LoggerManager&) = delete;
-    LoggerManager& operator=(const LoggerManager&) = delete;
-
-    static LoggerManager& GetInstance()
+    void Write(double value)
     {
-        if (instance == nullptr)
-        {
-            instance = new LoggerManager();
-        }
+        const auto tag = LogArgumentTag::Real;
+        Reserve(1 + sizeof(value));
+        Append(&tag, 1);
+        Append(&value, sizeof(value));
+    }
 
-        return *instance;
+    void Write(std::string_view value)
+    {
+        const auto tag = LogArgumentTag::Text;
+        const auto length = static_cast<std::uint32_t>(value.size());
+        Reserve(1 + sizeof(length) + value.size());
+        Append(&tag, 1);
+        Append(&length, sizeof(length));
+        Append(value.data(), value.size());
     }
 
-    void SetFactory(std::unique_ptr<LoggerFactory> newFactory)
+    const char* GetData() const { return data; }
+    size_t GetSize() const { return size; }
+};
+
+std::string FormatLogRecord(const char* record, size_t size, const char* pattern)
+{
+    std::string result;
+    if (pattern == nullptr)
     {
-        factory = std::move(newFactory);
+        return result;
     }
 
-    void Log(const std::string& message)
+    size_t position = sizeof(std::uint16_t);
+    for (const char* cursor = pattern; *cursor != '\0'; ++cursor)
     {
-        std::unique_ptr<ILogger> logger = factory->CreateLogger();
-        logger->Log(message);
+        if (cursor[0] != '{' || cursor[1] != '}')
+        {
+            result.push_back(*cursor);
+            continue;
+        }
+
+        ++cursor;
+        if (position >= size)
+        {
+            continue;
+        }
+
+        LogArgumentTag tag;
+        std::memcpy(&tag, record + position++, 1);
+        if (tag == LogArgumentTag::Integer && position + sizeof(std::int64_t) <= size)
+        {
+            std::int64_t value;
+            std::memcpy(&value, record + position, sizeof(value));
+            position += sizeof(value);
+            result += std::to_string(value);
+        }
+        else if (tag == LogArgumentTag::Real && position + sizeof(double) <= size)
+        {
+            double value;
+            std::memcpy(&value, record + position, sizeof(value));
+            position += sizeof(value);
+
+            char digits[32];
+            auto converted = std::to_chars(digits, digits + sizeof(digits), value);
+            result.append(digits, converted.ptr);
+        }
+        else if (tag == LogArgumentTag::Text && position + sizeof(std::uint32_t) <= size)
+        {
+            std::uint32_t length;
+            std::memcpy(&length, record + position, sizeof(length));
+            position += sizeof(length);
+            const size_t available = std::min<size_t>(length, size - position);
+            result.append(record + position, available);
+            position += available;
+        }
+        else
+        {
+            position = size;
+        }
     }
-};
 
-LoggerManager* LoggerManager::instance = nullptr;
+    return result;
+}
 
-class IDataProcessorStrategy
+std::uint16_t ReadLogFormatId(const char* record)
+{
+    std::uint16_t formatId;
+    std::memcpy(&formatId, record, sizeof(formatId));
+    return formatId;
+}
+
+std::string FormatLogRecord(const char* record, size_t size)
+{
+    return FormatLogRecord(record, size, LogFormat::Lookup(ReadLogFormatId(record)));
+}
+
+class ILogger
 {
 public:
-    virtual ~IDataProcessorStrategy() = default;
-    virtual std::string Process(const std::string& input) const = 0;
-    virtual std::string GetName() const = 0;
+    virtual ~ILogger() = default;
+    virtual void Log(const std::string& message) = 0;
+    virtual void Flush() {}
+
+    virtual void LogRecord(const char* record, size_t size)
+    {
+        Log(FormatLogRecord(record, size));
+    }
 };
 
-class EncryptDataStrategy : public IDataProcessorStrategy
+class ConsoleLogger : public ILogger
 {
 public:
-    std::string Process(const std::string& input) const override
+    void Log(const std::string& message) override
+    {
+        std::cout << "[consolelogger] " << message << '\n';
+    }
+
+    void Flush() override
     {
-        std::string result = input;
+        std::cout.flush();
+    }
+};
+
+struct FileLoggerOptions
+{
+    size_t flushThresholdBytes = 64 * 1024;
+    std::chrono::milliseconds flushInterval{1000};
+    size_t maxFileBytes = 0;
+    std::chrono::seconds maxFileAge{0};
+    size_t maxRotatedFiles = 5;
+};
+
+class FileLogger : public ILogger
+{
+private:
+    std::string filePath;
+    FileLoggerOptions options;
+    std::FILE* file = nullptr;
+    std::string buffer;
+    size_t fileSize = 0;
+    std::chrono::steady_clock::time_point lastFlush;
+    std::chrono::steady_clock::time_point fileOpened;
+    std::mutex mutex;
+    std::condition_variable flushTimer;
+    bool stopping = false;
+    std::thread flusher;
 
-        for (char& symbol : result)
+    void Open()
+    {
+        file = std::fopen(filePath.c_str(), "ab");
+        fileOpened = std::chrono::steady_clock::now();
+        if (file == nullptr)
         {
-            symbol = static_cast<char>(symbol + 1);
+            std::cerr << "file logger could not open " << filePath << ", buffered records are discarded" << std::endl;
         }
 
-        return result;
+        std::error_code error;
+        const auto existingSize = std::filesystem::file_size(filePath, error);
+        fileSize = error ? 0 : static_cast<size_t>(existingSize);
     }
 
-    std::string GetName() const override
+    std::string RotatedPath(size_t index) const
     {
-        return "encryptdatastrategy";
+        return filePath + "." + std::to_string(index);
     }
-};
 
-class CompressDataStrategy : public IDataProcessorStrategy
-{
-public:
-    std::string Process(const std::string& input) const override
+    void Rotate()
     {
-        std::string result;
+        if (file != nullptr)
+        {
+            std::fclose(file);
+            file = nullptr;
+        }
 
-        for (char symbol : input)
+        std::error_code error;
+        if (options.maxRotatedFiles == 0)
+        {
+            std::filesystem::remove(filePath, error);
+        }
+        else
         {
-            if (result.empty() || result.back() != symbol)
+            std::filesystem::remove(RotatedPath(options.maxRotatedFiles), error);
+            for (size_t index = options.maxRotatedFiles; index > 1; --index)
             {
-                result.push_back(symbol);
+                std::filesystem::rename(RotatedPath(index - 1), RotatedPath(index), error);
             }
+            std::filesystem::rename(filePath, RotatedPath(1), error);
         }
 
-        return result;
+        Open();
     }
 
-    std::string GetName() const override
+    bool NeedsRotation() const
     {
-        return "compressdatastrategy";
+        if (options.maxFileBytes > 0 && fileSize > 0 && fileSize + buffer.size() > options.maxFileBytes)
+        {
+            return true;
+        }
+
+        return options.maxFileAge.count() > 0 &&
+               std::chrono::steady_clock::now() - fileOpened >= options.maxFileAge;
     }
-};
 
-class DataContext
-{
-private:
-    const IDataProcessorStrategy* strategy;
+    void WriteBuffer()
+    {
+        if (buffer.empty())
+        {
+            return;
+        }
+
+        if (NeedsRotation())
+        {
+            Rotate();
+        }
+
+        if (file != nullptr)
+        {
+            std::fwrite(buffer.data(), 1, buffer.size(), file);
+            std::fflush(file);
+            fileSize += buffer.size();
+        }
+
+        buffer.clear();
+        lastFlush = std::chrono::steady_clock::now();
+    }
+
+    // Writes out records that have waited flushInterval even when no further Log call arrives.
+    void RunFlushTimer()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping)
+        {
+            flushTimer.wait_until(lock, lastFlush + options.flushInterval);
+            if (!stopping && std::chrono::steady_clock::now() - lastFlush >= options.flushInterval)
+            {
+                if (buffer.empty())
+                {
+                    lastFlush = std::chrono::steady_clock::now();
+                }
+                else
+                {
+                    WriteBuffer();
+                }
+            }
+        }
+    }
 
 public:
-    explicit DataContext(const IDataProcessorStrategy* initialStrategy)
-        : strategy(initialStrategy)
+    explicit FileLogger(const std::string& path, const FileLoggerOptions& loggerOptions = FileLoggerOptions())
+        : filePath(path), options(loggerOptions), lastFlush(std::chrono::steady_clock::now())
     {
+        buffer.reserve(options.flushThresholdBytes + 256);
+        Open();
+
+        if (options.flushInterval.count() > 0)
+        {
+            flusher = std::thread([this]() { RunFlushTimer(); });
+        }
     }
 
-    void SetStrategy(const IDataProcessorStrategy* newStrategy)
+    FileLogger(const FileLogger&) = delete;
+    FileLogger& operator=(const FileLogger&) = delete;
+
+    ~FileLogger() override
     {
-        strategy = newStrategy;
+        if (flusher.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            flushTimer.notify_one();
+            flusher.join();
+        }
+
+        Flush();
+        if (file != nullptr)
+        {
+            std::fclose(file);
+        }
     }
 
-    std::string ProcessData(const std::string& data) const
+    void Log(const std::string& message) override
     {
-        return strategy->Process(data);
+        std::lock_guard<std::mutex> lock(mutex);
+
+        buffer += "[filelogger] ";
+        buffer += message;
+        buffer += '\n';
+
+        if (buffer.size() >= options.flushThresholdBytes ||
+            (options.flushInterval.count() > 0 && std::chrono::steady_clock::now() - lastFlush >= options.flushInterval))
+        {
+            WriteBuffer();
+        }
     }
 
-    std::string GetStrategyName() const
+    void Flush() override
     {
-        return strategy->GetName();
+        std::lock_guard<std::mutex> lock(mutex);
+        WriteBuffer();
     }
 };
 
-class DataPublisher
+enum class QueueFullPolicy
 {
-public:
-    using DataProcessedHandler = std::function<void(const std::string&, const std::string&)>;
+    Block,
+    Drop,
+    DropAndCount
+};
 
+class LogRingBuffer
+{
 private:
-    std::vector<DataProcessedHandler> subscribers;
+    // Records up to the inline size are copied into the cell; longer ones are kept in overflow,
+    // which the consumer takes over, so nothing is truncated.
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        size_t length;
+        std::string overflow;
+        char data[LogRecordWriter::InlineRecordLength];
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueuePosition{0};
+    alignas(64) size_t dequeuePosition = 0;
 
 public:
-    void Subscribe(const DataProcessedHandler& handler)
+    explicit LogRingBuffer(size_t capacity)
     {
-        subscribers.push_back(handler);
+        size_t roundedCapacity = 2;
+        while (roundedCapacity < capacity)
+        {
+            roundedCapacity <<= 1;
+        }
+
+        cells = std::make_unique<Cell[]>(roundedCapacity);
+        mask = roundedCapacity - 1;
+        for (size_t i = 0; i < roundedCapacity; ++i)
+        {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
     }
 
-    void PublishDataProcessed(const std::string& processedData, const std::string& strategyName) const
+    bool TryPush(std::string_view record)
     {
-        for (const auto& subscriber : subscribers)
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        while (true)
         {
-            subscriber(processedData, strategyName);
+            Cell& cell = cells[position & mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+            if (difference == 0)
+            {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.length = record.size();
+                    if (record.size() <= sizeof(cell.data))
+                    {
+                        std::memcpy(cell.data, record.data(), record.size());
+                    }
+                    else
+                    {
+                        cell.overflow.assign(record);
+                    }
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false;
+            }
+            else
+            {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
         }
     }
-};
 
-class ProcessingLoggerObserver
-{
-public:
-    void OnDataProcessed(const std::string& processedData, const std::string& strategyName) const
+    bool TryPop(std::string& record)
     {
-        LoggerManager::GetInstance().Log(
-            "observer received processed data, strategy=" + strategyName + ", data=" + processedData);
+        Cell& cell = cells[dequeuePosition & mask];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (sequence != dequeuePosition + 1)
+        {
+            return false;
+        }
+
+        if (cell.length <= sizeof(cell.data))
+        {
+            record.assign(cell.data, cell.length);
+        }
+        else
+        {
+            record = std::move(cell.overflow);
+            std::string().swap(cell.overflow);
+        }
+
+        cell.sequence.store(dequeuePosition + mask + 1, std::memory_order_release);
+        ++dequeuePosition;
+        return true;
     }
 };
 
-void RunProcessingScenario(
-    const std::string& scenarioTitle,
-    DataContext& context,
-    const DataPublisher& publisher,
-    const std::string& input)
+class AsyncLogger : public ILogger
 {
-    std::cout << "\n========== " << scenarioTitle << " ==========" << std::endl;
+private:
+    static constexpr size_t BatchSize = 256;
 
-    const std::string processed = context.ProcessData(input);
-    LoggerManager::GetInstance().Log("data processed in context, input=" + input + ", output=" + processed);
-    publisher.PublishDataProcessed(processed, context.GetStrategyName());
-}
+    std::unique_ptr<ILogger> sink;
+    LogRingBuffer queue;
+    QueueFullPolicy policy;
+    std::atomic<bool> running{true};
+    std::atomic<size_t> droppedMessages{0};
+    std::atomic<size_t> pushedMessages{0};
+    std::atomic<size_t> writtenMessages{0};
+    size_t unflushedMessages = 0;
+    std::thread worker;
 
-int main()
-{
-    EncryptDataStrategy encryptStrategy;
-    CompressDataStrategy compressStrategy;
+    size_t DrainBatch(std::vector<std::string>& batch)
+    {
+        size_t count = 0;
+        while (count < batch.size() && queue.TryPop(batch[count]))
+        {
+            ++count;
+        }
 
-    DataContext context(&encryptStrategy);
-    DataPublisher publisher;
-    ProcessingLoggerObserver observer;
+        for (size_t i = 0; i < count; ++i)
+        {
+            sink->LogRecord(batch[i].data(), batch[i].size());
+        }
 
-    publisher.Subscribe(
-        [&observer](const std::string& processedData, const std::string& strategyName)
+        unflushedMessages += count;
+        if (unflushedMessages > 0 && count < batch.size())
         {
-            observer.OnDataProcessed(processedData, strategyName);
-        });
+            sink->Flush();
+            writtenMessages.fetch_add(unflushedMessages, std::memory_order_release);
+            unflushedMessages = 0;
+        }
+
+        return count;
+    }
+
+    void Run()
+    {
+        std::vector<std::string> batch(BatchSize);
+        size_t reportedDrops = 0;
+        auto idleDelay = std::chrono::microseconds(1);
+
+        while (running.load(std::memory_order_acquire))
+        {
+            if (DrainBatch(batch) > 0)
+            {
+                idleDelay = std::chrono::microseconds(1);
+            }
+            else
+            {
+                std::this_thread::sleep_for(idleDelay);
+                idleDelay = std::min(idleDelay * 2, std::chrono::microseconds(1000));
+            }
+
+            const size_t dropped = droppedMessages.load(std::memory_order_relaxed);
+            if (policy == QueueFullPolicy::DropAndCount && dropped != reportedDrops)
+            {
+                sink->Log("async logger dropped " + std::to_string(dropped - reportedDrops) + " messages");
+                sink->Flush();
+                reportedDrops = dropped;
+            }
+        }
+
+        while (DrainBatch(batch) > 0)
+        {
+        }
+    }
+
+public:
+    AsyncLogger(std::unique_ptr<ILogger> sinkLogger, size_t capacity, QueueFullPolicy fullPolicy)
+        : sink(std::move(sinkLogger)), queue(capacity), policy(fullPolicy)
+    {
+        worker = std::thread([this]() { Run(); });
+    }
+
+    ~AsyncLogger() override
+    {
+        running.store(false, std::memory_order_release);
+        worker.join();
+    }
+
+    void Log(const std::string& message) override
+    {
+        LogRecordWriter writer(LogFormat::Text().GetId());
+        writer.Write(std::string_view(message));
+        LogRecord(writer.GetData(), writer.GetSize());
+    }
+
+    void LogRecord(const char* record, size_t size) override
+    {
+        while (!queue.TryPush(std::string_view(record, size)))
+        {
+            if (policy != QueueFullPolicy::Block)
+            {
+                droppedMessages.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            std::this_thread::yield();
+        }
+
+        pushedMessages.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Flush() override
+    {
+        const size_t target = pushedMessages.load(std::memory_order_relaxed);
+        while (writtenMessages.load(std::memory_order_acquire) < target)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    size_t GetDroppedCount() const
+    {
+        return droppedMessages.load(std::memory_order_relaxed);
+    }
+};
+
+class BinaryFileLogger : public ILogger
+{
+private:
+    enum class FrameType : std::uint8_t
+    {
+        FormatDefinition = 1,
+        Record = 2
+    };
+
+    static constexpr size_t FlushThresholdBytes = 64 * 1024;
+
+    std::FILE* file;
+    std::string buffer;
+    std::unordered_set<std::uint16_t> definedFormats;
+    std::mutex mutex;
+
+    void AppendFrame(FrameType type, const char* payload, size_t size)
+    {
+        const auto length = static_cast<std::uint32_t>(size);
+        buffer.push_back(static_cast<char>(type));
+        buffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        buffer.append(payload, size);
+    }
+
+    void WriteBuffer()
+    {
+        if (file != nullptr && !buffer.empty())
+        {
+            std::fwrite(buffer.data(), 1, buffer.size(), file);
+            std::fflush(file);
+        }
+
+        buffer.clear();
+    }
+
+public:
+    explicit BinaryFileLogger(const std::string& path)
+        : file(std::fopen(path.c_str(), "ab"))
+    {
+        buffer.reserve(FlushThresholdBytes + 512);
+    }
+
+    BinaryFileLogger(const BinaryFileLogger&) = delete;
+    BinaryFileLogger& operator=(const BinaryFileLogger&) = delete;
+
+    ~BinaryFileLogger() override
+    {
+        Flush();
+        if (file != nullptr)
+        {
+            std::fclose(file);
+        }
+    }
+
+    void Log(const std::string& message) override
+    {
+        LogRecordWriter writer(LogFormat::Text().GetId());
+        writer.Write(std::string_view(message));
+        LogRecord(writer.GetData(), writer.GetSize());
+    }
+
+    void LogRecord(const char* record, size_t size) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        const std::uint16_t formatId = ReadLogFormatId(record);
+        if (definedFormats.insert(formatId).second)
+        {
+            const char* pattern = LogFormat::Lookup(formatId);
+            std::string definition(reinterpret_cast<const char*>(&formatId), sizeof(formatId));
+            definition += pattern != nullptr ? pattern : "";
+            AppendFrame(FrameType::FormatDefinition, definition.data(), definition.size());
+        }
+
+        AppendFrame(FrameType::Record, record, size);
+        if (buffer.size() >= FlushThresholdBytes)
+        {
+            WriteBuffer();
+        }
+    }
+
+    void Flush() override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        WriteBuffer();
+    }
+
+    static bool Decode(const std::string& path, std::ostream& output)
+    {
+        std::FILE* input = std::fopen(path.c_str(), "rb");
+        if (input == nullptr)
+        {
+            std::cerr << "could not open " << path << std::endl;
+            return false;
+        }
+
+        std::unordered_map<std::uint16_t, std::string> patterns;
+        std::string payload;
+        while (true)
+        {
+            char type;
+            std::uint32_t length;
+            if (std::fread(&type, 1, 1, input) != 1 || std::fread(&length, sizeof(length), 1, input) != 1)
+            {
+                break;
+            }
+
+            payload.resize(length);
+            if (std::fread(payload.data(), 1, length, input) != length || length < sizeof(std::uint16_t))
+            {
+                break;
+            }
+
+            const std::uint16_t formatId = ReadLogFormatId(payload.data());
+            if (type == static_cast<char>(FrameType::FormatDefinition))
+            {
+                patterns[formatId] = payload.substr(sizeof(formatId));
+            }
+            else if (type == static_cast<char>(FrameType::Record))
+            {
+                auto pattern = patterns.find(formatId);
+                output << "[binaryfilelogger] "
+                       << FormatLogRecord(payload.data(), payload.size(),
+                                          pattern != patterns.end() ? pattern->second.c_str() : "<unknown format>")
+                       << '\n';
+            }
+        }
+
+        std::fclose(input);
+        return true;
+    }
+};
+
+class LoggerFactory
+{
+public:
+    virtual ~LoggerFactory() = default;
+    virtual std::unique_ptr<ILogger> CreateLogger() const = 0;
+};
+
+class ConsoleLoggerFactory : public LoggerFactory
+{
+public:
+    std::unique_ptr<ILogger> CreateLogger() const override
+    {
+        return std::make_unique<ConsoleLogger>();
+    }
+};
+
+class FileLoggerFactory : public LoggerFactory
+{
+public:
+    std::unique_ptr<ILogger> CreateLogger() const override
+    {
+        return std::make_unique<FileLogger>("lab25_log.txt");
+    }
+};
+
+// Writes to the system temp directory by default so demo runs leave no file in the working tree.
+class BinaryFileLoggerFactory : public LoggerFactory
+{
+private:
+    std::string path;
+
+public:
+    explicit BinaryFileLoggerFactory(std::string filePath = DefaultPath())
+        : path(std::move(filePath))
+    {
+    }
+
+    static std::string DefaultPath()
+    {
+        return (std::filesystem::temp_directory_path() / "lab25_log.bin").string();
+    }
+
+    std::unique_ptr<ILogger> CreateLogger() const override
+    {
+        return std::make_unique<BinaryFileLogger>(path);
+    }
+};
+
+// Keeps formatted messages in memory, used to check what a logger chain actually delivered.
+class MemoryLogger : public ILogger
+{
+private:
+    std::shared_ptr<std::vector<std::string>> messages;
+
+public:
+    explicit MemoryLogger(std::shared_ptr<std::vector<std::string>> messageStore)
+        : messages(std::move(messageStore))
+    {
+    }
+
+    void Log(const std::string& message) override
+    {
+        messages->push_back(message);
+    }
+};
+
+class MemoryLoggerFactory : public LoggerFactory
+{
+private:
+    std::shared_ptr<std::vector<std::string>> messages;
+
+public:
+    explicit MemoryLoggerFactory(std::shared_ptr<std::vector<std::string>> messageStore)
+        : messages(std::move(messageStore))
+    {
+    }
+
+    std::unique_ptr<ILogger> CreateLogger() const override
+    {
+        return std::make_unique<MemoryLogger>(messages);
+    }
+};
+
+class LoggerManager
+{
+private:
+    struct alignas(64) ReaderCounter
+    {
+        std::atomic<size_t> active{0};
+    };
+
+    std::mutex configurationMutex;
+    std::unique_ptr<LoggerFactory> factory;
+    bool asyncMode = false;
+    size_t asyncCapacity = 4096;
+    QueueFullPolicy asyncPolicy = QueueFullPolicy::Block;
+
+    std::atomic<LogLevel> minimumLevel{LogLevel::Debug};
+    std::atomic<ILogger*> currentLogger{nullptr};
+    std::atomic<unsigned int> readerEpoch{0};
+    ReaderCounter readers[2];
+
+    template <typename Action>
+    void WithLogger(Action&& action)
+    {
+        ReaderCounter& counter = readers[readerEpoch.load() & 1];
+        counter.active.fetch_add(1);
+        action(*currentLogger.load());
+        counter.active.fetch_sub(1, std::memory_order_release);
+    }
+
+    void WaitForReaders()
+    {
+        for (int phase = 0; phase < 2; ++phase)
+        {
+            const unsigned int previousEpoch = readerEpoch.fetch_add(1) & 1;
+            while (readers[previousEpoch].active.load(std::memory_order_acquire) != 0)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void RebuildLogger()
+    {
+        std::unique_ptr<ILogger> created = factory->CreateLogger();
+        if (asyncMode)
+        {
+            created = std::make_unique<AsyncLogger>(std::move(created), asyncCapacity, asyncPolicy);
+        }
+
+        std::unique_ptr<ILogger> previous(currentLogger.exchange(created.release()));
+        if (previous)
+        {
+            WaitForReaders();
+            previous->Flush();
+        }
+    }
+
+    LoggerManager()
+        : factory(std::make_unique<ConsoleLoggerFactory>())
+    {
+        RebuildLogger();
+    }
+
+    ~LoggerManager()
+    {
+        delete currentLogger.exchange(nullptr);
+    }
+
+public:
+    LoggerManager(const LoggerManager&) = delete;
+    LoggerManager& operator=(const LoggerManager&) = delete;
+
+    static LoggerManager& GetInstance()
+    {
+        static LoggerManager instance;
+        return instance;
+    }
+
+    void SetFactory(std::unique_ptr<LoggerFactory> newFactory)
+    {
+        std::lock_guard<std::mutex> lock(configurationMutex);
+        factory = std::move(newFactory);
+        RebuildLogger();
+    }
+
+    void SetAsyncMode(bool enabled, size_t capacity = 4096, QueueFullPolicy policy = QueueFullPolicy::Block)
+    {
+        std::lock_guard<std::mutex> lock(configurationMutex);
+        asyncMode = enabled;
+        asyncCapacity = capacity;
+        asyncPolicy = policy;
+        RebuildLogger();
+    }
+
+    void Log(const std::string& message)
+    {
+        WithLogger([&message](ILogger& logger) { logger.Log(message); });
+    }
+
+    void SetMinimumLevel(LogLevel level)
+    {
+        minimumLevel.store(level, std::memory_order_relaxed);
+    }
+
+    bool IsEnabled(LogLevel level) const
+    {
+        return level >= CompiledMinLogLevel && level >= minimumLevel.load(std::memory_order_relaxed);
+    }
+
+    template <LogLevel Level>
+    void Log(const std::string& message)
+    {
+        if constexpr (Level >= CompiledMinLogLevel)
+        {
+            if (IsEnabled(Level))
+            {
+                Log(message);
+            }
+        }
+    }
+
+    template <LogLevel Level = LogLevel::Info, typename... Args>
+    void LogFormatted(const LogFormat& format, const Args&... args)
+    {
+        if constexpr (Level >= CompiledMinLogLevel)
+        {
+            if (IsEnabled(Level))
+            {
+                WriteRecord(format, args...);
+            }
+        }
+    }
+
+    template <LogLevel Level = LogLevel::Info, typename... Args>
+    void LogLimited(LogRateLimiter& limiter, const LogFormat& format, const Args&... args)
+    {
+        if constexpr (Level >= CompiledMinLogLevel)
+        {
+            if (IsEnabled(Level) && limiter.TryAcquire())
+            {
+                WriteRecord(format, args...);
+            }
+        }
+    }
+
+    void Flush()
+    {
+        WithLogger([](ILogger& logger) { logger.Flush(); });
+    }
+
+private:
+    template <typename... Args>
+    void WriteRecord(const LogFormat& format, const Args&... args)
+    {
+        LogRecordWriter writer(format.GetId());
+        (writer.Write(args), ...);
+
+        WithLogger([&writer](ILogger& logger) { logger.LogRecord(writer.GetData(), writer.GetSize()); });
+    }
+};
+
+class IStreamProcessor
+{
+public:
+    virtual ~IStreamProcessor() = default;
+    virtual void ProcessChunk(std::string_view input, std::string& output) = 0;
+    virtual void Finish(std::string&) {}
+};
+
+class IDataProcessorStrategy;
+
+class BufferedStreamProcessor : public IStreamProcessor
+{
+private:
+    const IDataProcessorStrategy& strategy;
+    std::string pending;
+
+public:
+    explicit BufferedStreamProcessor(const IDataProcessorStrategy& processorStrategy)
+        : strategy(processorStrategy)
+    {
+    }
+
+    void ProcessChunk(std::string_view input, std::string&) override
+    {
+        pending.append(input);
+    }
+
+    void Finish(std::string& output) override;
+};
+
+// How a strategy's output relates to contiguous pieces of its input, used by DataContext to decide
+// whether a large payload may be split across threads. ByteLocal means every input byte maps to
+// exactly one output byte independently of its neighbours.
+enum class DataLocality
+{
+    Sequential,
+    ByteLocal,
+    BlockLocal,
+    BoundaryFixup
+};
+
+class IDataProcessorStrategy
+{
+public:
+    virtual ~IDataProcessorStrategy() = default;
+    virtual std::string Process(const std::string& input) const = 0;
+    virtual std::string GetName() const = 0;
+
+    virtual DataLocality GetLocality() const
+    {
+        return DataLocality::Sequential;
+    }
+
+    // Segments handed to ProcessSegment are multiples of this size except for the last one.
+    virtual size_t GetLocalityBlockSize() const
+    {
+        return 1;
+    }
+
+    virtual void ProcessSegment(std::string_view input, std::string& output) const
+    {
+        output = Process(std::string(input));
+    }
+
+    // For ByteLocal strategies: output has exactly input.size() bytes.
+    virtual void ProcessSegmentInto(std::string_view input, std::span<char> output) const
+    {
+        std::string processed;
+        ProcessSegment(input, processed);
+        std::memcpy(output.data(), processed.data(), std::min(processed.size(), output.size()));
+    }
+
+    // For BoundaryFixup strategies: how many leading bytes of a segment's output duplicate the
+    // tail of the previous segment's output and must be dropped when stitching.
+    virtual size_t GetSegmentOverlap(std::string_view, std::string_view) const
+    {
+        return 0;
+    }
+
+    virtual std::unique_ptr<IStreamProcessor> CreateStreamProcessor() const
+    {
+        return std::make_unique<BufferedStreamProcessor>(*this);
+    }
+};
+
+void BufferedStreamProcessor::Finish(std::string& output)
+{
+    output += strategy.Process(pending);
+    pending.clear();
+}
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define LAB25_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+class ByteKernels
+{
+private:
+#ifdef LAB25_X86_SIMD
+    struct CompressShuffleTable
+    {
+        std::uint64_t indices[256];
+
+        CompressShuffleTable()
+        {
+            for (unsigned int mask = 0; mask < 256; ++mask)
+            {
+                std::uint64_t packed = 0;
+                unsigned int slot = 0;
+                for (unsigned int bit = 0; bit < 8; ++bit)
+                {
+                    if (mask & (1u << bit))
+                    {
+                        packed |= static_cast<std::uint64_t>(bit) << (8 * slot++);
+                    }
+                }
+                indices[mask] = packed;
+            }
+        }
+    };
+
+    static const CompressShuffleTable& ShuffleTable()
+    {
+        static const CompressShuffleTable table;
+        return table;
+    }
+
+    static bool HasAvx2()
+    {
+        static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+        return supported;
+    }
+
+    __attribute__((target("avx2")))
+    static size_t IncrementAvx2(const char* input, char* output, size_t size)
+    {
+        const __m256i one = _mm256_set1_epi8(1);
+        size_t i = 0;
+        for (; i + 32 <= size; i += 32)
+        {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), _mm256_add_epi8(block, one));
+        }
+
+        return i;
+    }
+
+    __attribute__((target("avx2,popcnt")))
+    static size_t DedupeAvx2(const char* input, size_t size, char* output, int& previous, size_t& consumed)
+    {
+        const std::uint64_t* table = ShuffleTable().indices;
+        __m256i previousBlock = _mm256_set1_epi8(static_cast<char>(previous));
+        bool hasPrevious = previous >= 0;
+        char* out = output;
+
+        size_t i = 0;
+        for (; i + 32 <= size; i += 32)
+        {
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+            const __m256i shifted = _mm256_alignr_epi8(block, _mm256_permute2x128_si256(previousBlock, block, 0x21), 15);
+            std::uint32_t keep = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, shifted)));
+            if (!hasPrevious)
+            {
+                keep |= 1u;
+                hasPrevious = true;
+            }
+
+            const __m128i halves[2] = {_mm256_castsi256_si128(block), _mm256_extracti128_si256(block, 1)};
+            for (unsigned int group = 0; group < 4; ++group)
+            {
+                const unsigned int mask = (keep >> (8 * group)) & 0xFF;
+                const __m128i indices = _mm_add_epi8(_mm_cvtsi64_si128(static_cast<long long>(table[mask])),
+                                                     _mm_set1_epi8(static_cast<char>((group & 1) * 8)));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(halves[group >> 1], indices));
+                out += _mm_popcnt_u32(mask);
+            }
+
+            previousBlock = block;
+        }
+
+        if (i > 0)
+        {
+            previous = static_cast<unsigned char>(_mm256_extract_epi8(previousBlock, 31));
+        }
+
+        consumed = i;
+        return static_cast<size_t>(out - output);
+    }
+#endif
+
+public:
+    static void Increment(const char* input, char* output, size_t size)
+    {
+        size_t i = 0;
+#ifdef LAB25_X86_SIMD
+        if (HasAvx2())
+        {
+            i = IncrementAvx2(input, output, size);
+        }
+#endif
+        for (; i < size; ++i)
+        {
+            output[i] = static_cast<char>(input[i] + 1);
+        }
+    }
+
+    static size_t RemoveAdjacentDuplicates(const char* input, size_t size, char* output, int& previous)
+    {
+        size_t i = 0;
+        size_t written = 0;
+#ifdef LAB25_X86_SIMD
+        if (HasAvx2())
+        {
+            written = DedupeAvx2(input, size, output, previous, i);
+        }
+#endif
+        for (; i < size; ++i)
+        {
+            const int symbol = static_cast<unsigned char>(input[i]);
+            if (symbol != previous)
+            {
+                output[written++] = input[i];
+                previous = symbol;
+            }
+        }
+
+        return written;
+    }
+};
+
+class EncryptStreamProcessor : public IStreamProcessor
+{
+public:
+    void ProcessChunk(std::string_view input, std::string& output) override
+    {
+        const size_t start = output.size();
+        output.resize(start + input.size());
+        ByteKernels::Increment(input.data(), output.data() + start, input.size());
+    }
+};
+
+class CompressStreamProcessor : public IStreamProcessor
+{
+private:
+    int previous = -1;
+
+public:
+    void ProcessChunk(std::string_view input, std::string& output) override
+    {
+        const size_t start = output.size();
+        output.resize(start + input.size());
+        const size_t written = ByteKernels::RemoveAdjacentDuplicates(input.data(), input.size(), output.data() + start, previous);
+        output.resize(start + written);
+    }
+};
+
+class EncryptDataStrategy : public IDataProcessorStrategy
+{
+public:
+    std::string Process(const std::string& input) const override
+    {
+        std::string result(input.size(), '\0');
+        ProcessInto(input, result);
+        return result;
+    }
+
+    void ProcessInPlace(std::span<char> data) const
+    {
+        ByteKernels::Increment(data.data(), data.data(), data.size());
+    }
+
+    size_t ProcessInto(std::span<const char> input, std::span<char> output) const
+    {
+        const size_t size = std::min(input.size(), output.size());
+        ByteKernels::Increment(input.data(), output.data(), size);
+        return size;
+    }
+
+    std::string GetName() const override
+    {
+        return "encryptdatastrategy";
+    }
+
+    DataLocality GetLocality() const override
+    {
+        return DataLocality::ByteLocal;
+    }
+
+    void ProcessSegment(std::string_view input, std::string& output) const override
+    {
+        output.resize(input.size());
+        ProcessInto(input, output);
+    }
+
+    void ProcessSegmentInto(std::string_view input, std::span<char> output) const override
+    {
+        ProcessInto(input, output);
+    }
+
+    std::unique_ptr<IStreamProcessor> CreateStreamProcessor() const override
+    {
+        return std::make_unique<EncryptStreamProcessor>();
+    }
+};
+
+class CompressDataStrategy : public IDataProcessorStrategy
+{
+public:
+    std::string Process(const std::string& input) const override
+    {
+        std::string result(input.size(), '\0');
+        result.resize(ProcessInto(input, result));
+        return result;
+    }
+
+    size_t ProcessInPlace(std::span<char> data) const
+    {
+        int previous = -1;
+        return ByteKernels::RemoveAdjacentDuplicates(data.data(), data.size(), data.data(), previous);
+    }
+
+    size_t ProcessInto(std::span<const char> input, std::span<char> output) const
+    {
+        if (output.size() < input.size())
+        {
+            throw std::length_error("compress output buffer must be at least as large as the input");
+        }
+
+        int previous = -1;
+        return ByteKernels::RemoveAdjacentDuplicates(input.data(), input.size(), output.data(), previous);
+    }
+
+    std::string GetName() const override
+    {
+        return "compressdatastrategy";
+    }
+
+    DataLocality GetLocality() const override
+    {
+        return DataLocality::BoundaryFixup;
+    }
+
+    void ProcessSegment(std::string_view input, std::string& output) const override
+    {
+        output.resize(input.size());
+        output.resize(ProcessInto(input, output));
+    }
+
+    size_t GetSegmentOverlap(std::string_view previousOutput, std::string_view segmentOutput) const override
+    {
+        return !previousOutput.empty() && !segmentOutput.empty() && previousOutput.back() == segmentOutput.front() ? 1 : 0;
+    }
+
+    std::unique_ptr<IStreamProcessor> CreateStreamProcessor() const override
+    {
+        return std::make_unique<CompressStreamProcessor>();
+    }
+};
+
+class LzBlockCodec
+{
+private:
+    enum class BlockMethod : std::uint8_t
+    {
+        Stored = 0,
+        Lz = 1
+    };
+
+    struct FrameHeader
+    {
+        std::uint32_t magic;
+        std::uint8_t method;
+        std::uint32_t originalSize;
+        std::uint32_t payloadSize;
+        std::uint32_t checksum;
+    };
+
+    static constexpr std::uint32_t FrameMagic = 0x5A353241;
+    static constexpr size_t MinMatch = 4;
+    static constexpr size_t MaxOffset = 65535;
+    static constexpr size_t LastLiterals = 5;
+    static constexpr unsigned int HashBits = 14;
+
+    static std::uint32_t Load32(const char* data)
+    {
+        std::uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    static std::uint64_t Load64(const char* data)
+    {
+        std::uint64_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    static unsigned int HashBitsFor(size_t size)
+    {
+        return std::clamp(static_cast<unsigned int>(std::bit_width(size)) - 1, 8u, HashBits);
+    }
+
+    static std::uint32_t Hash(std::uint32_t sequence, unsigned int bits)
+    {
+        return (sequence * 2654435761u) >> (32 - bits);
+    }
+
+    static void AppendLength(std::string& output, size_t length)
+    {
+        for (; length >= 255; length -= 255)
+        {
+            output.push_back(static_cast<char>(255));
+        }
+        output.push_back(static_cast<char>(length));
+    }
+
+    static void AppendSequence(std::string& output, const char* literals, size_t literalLength, size_t offset, size_t matchLength)
+    {
+        const size_t extraMatch = matchLength >= MinMatch ? matchLength - MinMatch : 0;
+        const auto literalNibble = static_cast<unsigned int>(std::min<size_t>(literalLength, 15));
+        const auto matchNibble = static_cast<unsigned int>(std::min<size_t>(extraMatch, 15));
+        output.push_back(static_cast<char>((literalNibble << 4) | matchNibble));
+        if (literalLength >= 15)
+        {
+            AppendLength(output, literalLength - 15);
+        }
+        output.append(literals, literalLength);
+
+        if (matchLength == 0)
+        {
+            return;
+        }
+
+        const auto offset16 = static_cast<std::uint16_t>(offset);
+        output.append(reinterpret_cast<const char*>(&offset16), sizeof(offset16));
+        if (extraMatch >= 15)
+        {
+            AppendLength(output, extraMatch - 15);
+        }
+    }
+
+    static void CompressBlock(const char* input, size_t size, std::string& output, std::vector<std::uint32_t>& table)
+    {
+        const unsigned int bits = HashBitsFor(std::min(size, table.size()));
+        std::fill_n(table.begin(), size_t{1} << bits, 0);
+
+        size_t anchor = 0;
+        size_t position = 0;
+        const size_t matchLimit = size > LastLiterals ? size - LastLiterals : 0;
+
+        while (position + MinMatch <= matchLimit)
+        {
+            const std::uint32_t sequence = Load32(input + position);
+            std::uint32_t& slot = table[Hash(sequence, bits)];
+            const size_t candidate = slot;
+            slot = static_cast<std::uint32_t>(position + 1);
+
+            if (candidate == 0 || position + 1 - candidate > MaxOffset || Load32(input + candidate - 1) != sequence)
+            {
+                position += 1 + ((position - anchor) >> 6);
+                continue;
+            }
+
+            const size_t matchStart = candidate - 1;
+            size_t length = MinMatch;
+            while (position + length + sizeof(std::uint64_t) <= matchLimit)
+            {
+                const std::uint64_t difference = Load64(input + matchStart + length) ^ Load64(input + position + length);
+                if (difference != 0)
+                {
+                    length += static_cast<size_t>(std::countr_zero(difference)) / 8;
+                    break;
+                }
+                length += sizeof(std::uint64_t);
+            }
+            while (position + length < matchLimit && input[matchStart + length] == input[position + length])
+            {
+                ++length;
+            }
+
+            AppendSequence(output, input + anchor, position - anchor, position - matchStart, length);
+            position += length;
+            anchor = position;
+        }
+
+        AppendSequence(output, input + anchor, size - anchor, 0, 0);
+    }
+
+    static size_t ReadLength(const char*& in, const char* end, size_t length)
+    {
+        if (length != 15)
+        {
+            return length;
+        }
+
+        while (true)
+        {
+            if (in == end)
+            {
+                throw std::runtime_error("lz frame: truncated length");
+            }
+
+            const auto extra = static_cast<unsigned char>(*in++);
+            length += extra;
+            if (extra != 255)
+            {
+                return length;
+            }
+        }
+    }
+
+    // output must have CopySlack writable bytes past originalSize: short literals and matches are
+    // copied in whole 16/8-byte steps and may overshoot the exact length.
+    static void DecompressBlock(const char* in, size_t size, char* output, size_t originalSize)
+    {
+        const char* end = in + size;
+        size_t written = 0;
+
+        while (in < end)
+        {
+            const auto token = static_cast<unsigned char>(*in++);
+
+            const size_t literalLength = ReadLength(in, end, token >> 4);
+            if (literalLength > static_cast<size_t>(end - in) || literalLength > originalSize - written)
+            {
+                throw std::runtime_error("lz frame: literals overrun");
+            }
+
+            if (literalLength <= CopySlack && static_cast<size_t>(end - in) >= CopySlack)
+            {
+                std::memcpy(output + written, in, CopySlack);
+            }
+            else
+            {
+                std::memcpy(output + written, in, literalLength);
+            }
+            in += literalLength;
+            written += literalLength;
+
+            if (in == end)
+            {
+                break;
+            }
+
+            if (end - in < 2)
+            {
+                throw std::runtime_error("lz frame: truncated offset");
+            }
+
+            std::uint16_t offset;
+            std::memcpy(&offset, in, sizeof(offset));
+            in += sizeof(offset);
+
+            const size_t matchLength = ReadLength(in, end, token & 0x0F) + MinMatch;
+            if (offset == 0 || offset > written || matchLength > originalSize - written)
+            {
+                throw std::runtime_error("lz frame: invalid match");
+            }
+
+            const char* source = output + written - offset;
+            char* destination = output + written;
+            if (offset == 1)
+            {
+                std::memset(destination, static_cast<unsigned char>(*source), matchLength);
+            }
+            else if (offset >= sizeof(std::uint64_t))
+            {
+                for (size_t i = 0; i < matchLength; i += sizeof(std::uint64_t))
+                {
+                    std::memcpy(destination + i, source + i, sizeof(std::uint64_t));
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < matchLength; ++i)
+                {
+                    destination[i] = source[i];
+                }
+            }
+            written += matchLength;
+        }
+
+        if (written != originalSize)
+        {
+            throw std::runtime_error("lz frame: size mismatch");
+        }
+    }
+
+    static void AppendHeader(std::string& output, const FrameHeader& header)
+    {
+        output.append(reinterpret_cast<const char*>(&header.magic), sizeof(header.magic));
+        output.push_back(static_cast<char>(header.method));
+        output.append(reinterpret_cast<const char*>(&header.originalSize), sizeof(header.originalSize));
+        output.append(reinterpret_cast<const char*>(&header.payloadSize), sizeof(header.payloadSize));
+        output.append(reinterpret_cast<const char*>(&header.checksum), sizeof(header.checksum));
+    }
+
+    static FrameHeader ReadHeader(const char* data)
+    {
+        FrameHeader header;
+        std::memcpy(&header.magic, data, sizeof(header.magic));
+        header.method = static_cast<std::uint8_t>(data[4]);
+        std::memcpy(&header.originalSize, data + 5, sizeof(header.originalSize));
+        std::memcpy(&header.payloadSize, data + 9, sizeof(header.payloadSize));
+        std::memcpy(&header.checksum, data + 13, sizeof(header.checksum));
+        return header;
+    }
+
+public:
+    static constexpr size_t BlockSize = 1024 * 1024;
+    static constexpr size_t FrameHeaderSize = 17;
+    static constexpr size_t CopySlack = 16;
+
+    static std::uint32_t Checksum(const char* data, size_t size)
+    {
+        constexpr std::uint32_t Modulus = 65521;
+        constexpr size_t MaxRun = 5552;
+
+        std::uint64_t a = 1;
+        std::uint64_t b = 0;
+        while (size > 0)
+        {
+            const size_t run = std::min(size, MaxRun);
+            std::uint32_t sum = 0;
+            std::uint32_t weighted = 0;
+            for (size_t i = 0; i < run; ++i)
+            {
+                const std::uint32_t symbol = static_cast<unsigned char>(data[i]);
+                sum += symbol;
+                weighted += static_cast<std::uint32_t>(run - i) * symbol;
+            }
+            b = (b + run * a + weighted) % Modulus;
+            a = (a + sum) % Modulus;
+            data += run;
+            size -= run;
+        }
+
+        return static_cast<std::uint32_t>((b << 16) | a);
+    }
+
+    static void AppendFrame(std::string& output, std::string_view block, std::vector<std::uint32_t>& table)
+    {
+        const size_t headerPosition = output.size();
+        AppendHeader(output, FrameHeader{FrameMagic, static_cast<std::uint8_t>(BlockMethod::Lz),
+                                         static_cast<std::uint32_t>(block.size()), 0,
+                                         Checksum(block.data(), block.size())});
+
+        CompressBlock(block.data(), block.size(), output, table);
+
+        std::uint8_t method = static_cast<std::uint8_t>(BlockMethod::Lz);
+        size_t payloadSize = output.size() - headerPosition - FrameHeaderSize;
+        if (payloadSize >= block.size())
+        {
+            output.resize(headerPosition + FrameHeaderSize);
+            output.append(block);
+            method = static_cast<std::uint8_t>(BlockMethod::Stored);
+            payloadSize = block.size();
+        }
+
+        const auto payloadSize32 = static_cast<std::uint32_t>(payloadSize);
+        output[headerPosition + 4] = static_cast<char>(method);
+        std::memcpy(output.data() + headerPosition + 9, &payloadSize32, sizeof(payloadSize32));
+    }
+
+    static std::vector<std::uint32_t> CreateHashTable(size_t inputSize = BlockSize)
+    {
+        return std::vector<std::uint32_t>(size_t{1} << HashBitsFor(inputSize));
+    }
+
+    static size_t DecodedSize(std::string_view encoded)
+    {
+        size_t total = 0;
+        for (size_t position = 0; encoded.size() - position >= FrameHeaderSize;)
+        {
+            const FrameHeader header = ReadHeader(encoded.data() + position);
+            if (header.originalSize > BlockSize)
+            {
+                break;
+            }
+
+            total += header.originalSize;
+            position += FrameHeaderSize + header.payloadSize;
+            if (position > encoded.size())
+            {
+                break;
+            }
+        }
+
+        return total;
+    }
+
+    static std::string Decode(std::string_view encoded)
+    {
+        std::string output;
+        output.reserve(std::min(DecodedSize(encoded), encoded.size() * 256) + CopySlack);
+        size_t position = 0;
+        while (position < encoded.size())
+        {
+            if (encoded.size() - position < FrameHeaderSize)
+            {
+                throw std::runtime_error("lz frame: truncated header");
+            }
+
+            const FrameHeader header = ReadHeader(encoded.data() + position);
+            position += FrameHeaderSize;
+            if (header.magic != FrameMagic)
+            {
+                throw std::runtime_error("lz frame: bad magic");
+            }
+            if (header.payloadSize > encoded.size() - position || header.originalSize > BlockSize)
+            {
+                throw std::runtime_error("lz frame: bad size");
+            }
+
+            const size_t start = output.size();
+            output.resize(start + header.originalSize + CopySlack);
+            const char* payload = encoded.data() + position;
+
+            if (header.method == static_cast<std::uint8_t>(BlockMethod::Stored))
+            {
+                if (header.payloadSize != header.originalSize)
+                {
+                    throw std::runtime_error("lz frame: bad stored size");
+                }
+                std::memcpy(output.data() + start, payload, header.payloadSize);
+            }
+            else if (header.method == static_cast<std::uint8_t>(BlockMethod::Lz))
+            {
+                DecompressBlock(payload, header.payloadSize, output.data() + start, header.originalSize);
+            }
+            else
+            {
+                throw std::runtime_error("lz frame: unknown method");
+            }
+
+            output.resize(start + header.originalSize);
+            if (Checksum(output.data() + start, header.originalSize) != header.checksum)
+            {
+                throw std::runtime_error("lz frame: checksum mismatch");
+            }
+
+            position += header.payloadSize;
+        }
+
+        return output;
+    }
+};
+
+class LzCodecStreamProcessor : public IStreamProcessor
+{
+private:
+    std::vector<std::uint32_t> table = LzBlockCodec::CreateHashTable();
+    std::string pending;
+
+public:
+    void ProcessChunk(std::string_view input, std::string& output) override
+    {
+        while (pending.empty() && input.size() >= LzBlockCodec::BlockSize)
+        {
+            LzBlockCodec::AppendFrame(output, input.substr(0, LzBlockCodec::BlockSize), table);
+            input.remove_prefix(LzBlockCodec::BlockSize);
+        }
+
+        while (!input.empty())
+        {
+            const size_t take = std::min(input.size(), LzBlockCodec::BlockSize - pending.size());
+            pending.append(input.substr(0, take));
+            input.remove_prefix(take);
+            if (pending.size() == LzBlockCodec::BlockSize)
+            {
+                LzBlockCodec::AppendFrame(output, pending, table);
+                pending.clear();
+            }
+        }
+    }
+
+    void Finish(std::string& output) override
+    {
+        if (!pending.empty())
+        {
+            LzBlockCodec::AppendFrame(output, pending, table);
+            pending.clear();
+        }
+    }
+};
+
+class LzCodecDataStrategy : public IDataProcessorStrategy
+{
+public:
+    std::string Process(const std::string& input) const override
+    {
+        std::string output;
+        ProcessSegment(input, output);
+        return output;
+    }
+
+    void ProcessSegment(std::string_view input, std::string& output) const override
+    {
+        std::vector<std::uint32_t> table = LzBlockCodec::CreateHashTable(input.size());
+        output.clear();
+        output.reserve(input.size() / 2 + LzBlockCodec::FrameHeaderSize);
+
+        size_t offset = 0;
+        while (offset < input.size())
+        {
+            const std::string_view block = input.substr(offset, LzBlockCodec::BlockSize);
+            LzBlockCodec::AppendFrame(output, block, table);
+            offset += block.size();
+        }
+    }
+
+    DataLocality GetLocality() const override
+    {
+        return DataLocality::BlockLocal;
+    }
+
+    size_t GetLocalityBlockSize() const override
+    {
+        return LzBlockCodec::BlockSize;
+    }
+
+    static std::string Decode(std::string_view encoded)
+    {
+        return LzBlockCodec::Decode(encoded);
+    }
+
+    std::string GetName() const override
+    {
+        return "lzcodecdatastrategy";
+    }
+
+    std::unique_ptr<IStreamProcessor> CreateStreamProcessor() const override
+    {
+        return std::make_unique<LzCodecStreamProcessor>();
+    }
+};
+
+// Deliberate copy of the pool in lab24/lab24.cpp: every lab builds from a single file. Apply fixes to both.
+class WorkStealingPool
+{
+private:
+    struct alignas(64) WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queuedTasks{0};
+    std::atomic<size_t> nextQueue{0};
+    std::atomic<bool> running{true};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+
+    bool TryPopOwn(size_t index, std::function<void()>& task)
+    {
+        WorkerQueue& queue = *queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+        {
+            return false;
+        }
+
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool TrySteal(size_t thief, std::function<void()>& task)
+    {
+        for (size_t offset = 1; offset <= queues.size(); ++offset)
+        {
+            WorkerQueue& queue = *queues[(thief + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.tasks.empty())
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool RunOne(size_t index)
+    {
+        std::function<void()> task;
+        if (!TryPopOwn(index, task) && !TrySteal(index, task))
+        {
+            return false;
+        }
+
+        queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+        task();
+        return true;
+    }
+
+    void RunWorker(size_t index)
+    {
+        while (running.load(std::memory_order_acquire))
+        {
+            if (RunOne(index))
+            {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this]()
+            {
+                return !running.load(std::memory_order_acquire) || queuedTasks.load(std::memory_order_relaxed) > 0;
+            });
+        }
+    }
+
+public:
+    explicit WorkStealingPool(size_t threadCount = std::thread::hardware_concurrency())
+    {
+        threadCount = std::max<size_t>(threadCount, 1);
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            workers.emplace_back([this, i]() { RunWorker(i); });
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    ~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            running.store(false, std::memory_order_release);
+        }
+        wake.notify_all();
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    size_t GetThreadCount() const
+    {
+        return workers.size();
+    }
+
+    // Runs body(0) .. body(count - 1) on the pool and returns when all of them finished. The calling
+    // thread executes and steals tasks while it waits, so nested calls from a task do not deadlock.
+    template <typename Body>
+    void ParallelFor(size_t count, Body&& body)
+    {
+        std::atomic<size_t> remaining{count};
+        std::exception_ptr failure;
+        std::mutex failureMutex;
+
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            queuedTasks.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            WorkerQueue& queue = *queues[nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.emplace_back([&, i]()
+            {
+                try
+                {
+                    body(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> failureLock(failureMutex);
+                    if (!failure)
+                    {
+                        failure = std::current_exception();
+                    }
+                }
+                remaining.fetch_sub(1, std::memory_order_acq_rel);
+            });
+        }
+
+        wake.notify_all();
+
+        const size_t helperIndex = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        while (remaining.load(std::memory_order_acquire) > 0)
+        {
+            if (!RunOne(helperIndex))
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        if (failure)
+        {
+            std::rethrow_exception(failure);
+        }
+    }
+};
+
+class DataContext
+{
+private:
+    const IDataProcessorStrategy* strategy;
+    std::unique_ptr<WorkStealingPool> pool;
+    size_t parallelThreshold = 4 * 1024 * 1024;
+
+    std::string ProcessParallel(const std::string& data) const
+    {
+        const DataLocality locality = strategy->GetLocality();
+        const size_t blockSize = std::max<size_t>(strategy->GetLocalityBlockSize(), 1);
+
+        // Several segments per thread so stealing can even out uneven segment costs.
+        size_t segmentSize = std::max<size_t>(data.size() / (pool->GetThreadCount() * 4), 256 * 1024);
+        segmentSize = std::max(blockSize, segmentSize / blockSize * blockSize);
+        const size_t segmentCount = (data.size() + segmentSize - 1) / segmentSize;
+
+        const std::string_view input(data);
+        if (locality == DataLocality::ByteLocal)
+        {
+            std::string result(data.size(), '\0');
+            pool->ParallelFor(segmentCount, [&](size_t segment)
+            {
+                const size_t offset = segment * segmentSize;
+                const size_t size = std::min(segmentSize, data.size() - offset);
+                strategy->ProcessSegmentInto(input.substr(offset, size), std::span<char>(result.data() + offset, size));
+            });
+            return result;
+        }
+
+        std::vector<std::string> outputs(segmentCount);
+        pool->ParallelFor(segmentCount, [&](size_t segment)
+        {
+            strategy->ProcessSegment(input.substr(segment * segmentSize, segmentSize), outputs[segment]);
+        });
+
+        std::vector<size_t> skips(segmentCount, 0);
+        std::vector<size_t> offsets(segmentCount + 1, 0);
+        for (size_t segment = 0; segment < segmentCount; ++segment)
+        {
+            if (locality == DataLocality::BoundaryFixup && segment > 0)
+            {
+                skips[segment] = std::min(outputs[segment].size(),
+                                          strategy->GetSegmentOverlap(outputs[segment - 1], outputs[segment]));
+            }
+            offsets[segment + 1] = offsets[segment] + outputs[segment].size() - skips[segment];
+        }
+
+        std::string result(offsets.back(), '\0');
+        pool->ParallelFor(segmentCount, [&](size_t segment)
+        {
+            std::memcpy(result.data() + offsets[segment], outputs[segment].data() + skips[segment],
+                        offsets[segment + 1] - offsets[segment]);
+        });
+
+        return result;
+    }
+
+public:
+    explicit DataContext(const IDataProcessorStrategy* initialStrategy)
+        : strategy(initialStrategy)
+    {
+    }
+
+    void SetStrategy(const IDataProcessorStrategy* newStrategy)
+    {
+        strategy = newStrategy;
+    }
+
+    // Inputs of at least thresholdBytes are split into segments and processed on a work-stealing
+    // pool when the strategy's locality allows it. threadCount 0 turns parallel mode off.
+    void SetParallelMode(size_t threadCount, size_t thresholdBytes = 4 * 1024 * 1024)
+    {
+        pool = threadCount > 0 ? std::make_unique<WorkStealingPool>(threadCount) : nullptr;
+        parallelThreshold = thresholdBytes;
+    }
+
+    std::string ProcessData(const std::string& data) const
+    {
+        if (pool && data.size() >= parallelThreshold && strategy->GetLocality() != DataLocality::Sequential)
+        {
+            return ProcessParallel(data);
+        }
+
+        return strategy->Process(data);
+    }
+
+    std::string GetStrategyName() const
+    {
+        return strategy->GetName();
+    }
+};
+
+class DataPipeline
+{
+private:
+    std::vector<const IDataProcessorStrategy*> stages;
+    size_t chunkSize;
+
+    void PushThrough(std::vector<std::unique_ptr<IStreamProcessor>>& processors,
+                     std::vector<std::string>& buffers, size_t firstStage, std::string_view input) const
+    {
+        for (size_t stage = firstStage; stage < processors.size(); ++stage)
+        {
+            buffers[stage].clear();
+            processors[stage]->ProcessChunk(input, buffers[stage]);
+            input = buffers[stage];
+        }
+    }
+
+public:
+    explicit DataPipeline(size_t pipelineChunkSize = 64 * 1024)
+        : chunkSize(pipelineChunkSize > 0 ? pipelineChunkSize : 1)
+    {
+    }
+
+    DataPipeline& AddStage(const IDataProcessorStrategy* strategy)
+    {
+        stages.push_back(strategy);
+        return *this;
+    }
+
+    std::string GetName() const
+    {
+        std::string name;
+        for (const auto* stage : stages)
+        {
+            if (!name.empty())
+            {
+                name += '>';
+            }
+            name += stage->GetName();
+        }
+
+        return name;
+    }
+
+    size_t Run(std::istream& input, std::ostream& output) const
+    {
+        std::vector<std::unique_ptr<IStreamProcessor>> processors;
+        for (const auto* stage : stages)
+        {
+            processors.push_back(stage->CreateStreamProcessor());
+        }
+
+        std::vector<std::string> buffers(processors.size());
+        std::string chunk(chunkSize, '\0');
+        size_t written = 0;
+
+        auto emit = [&](std::string_view data)
+        {
+            output.write(data.data(), static_cast<std::streamsize>(data.size()));
+            written += data.size();
+        };
+
+        while (input.read(chunk.data(), static_cast<std::streamsize>(chunk.size())) || input.gcount() > 0)
+        {
+            const std::string_view data(chunk.data(), static_cast<size_t>(input.gcount()));
+            if (processors.empty())
+            {
+                emit(data);
+                continue;
+            }
+
+            PushThrough(processors, buffers, 0, data);
+            emit(buffers.back());
+        }
+
+        std::string tail;
+        for (size_t stage = 0; stage < processors.size(); ++stage)
+        {
+            tail.clear();
+            processors[stage]->Finish(tail);
+            if (stage + 1 < processors.size())
+            {
+                PushThrough(processors, buffers, stage + 1, tail);
+                emit(buffers.back());
+            }
+            else
+            {
+                emit(tail);
+            }
+        }
+
+        return written;
+    }
+
+    std::string Process(const std::string& data) const
+    {
+        std::istringstream input(data);
+        std::ostringstream output;
+        Run(input, output);
+        return output.str();
+    }
+
+    bool RunFile(const std::string& inputPath, const std::string& outputPath) const
+    {
+        std::ifstream input(inputPath, std::ios::binary);
+        std::ofstream output(outputPath, std::ios::binary);
+        if (!input.is_open() || !output.is_open())
+        {
+            return false;
+        }
+
+        Run(input, output);
+        return static_cast<bool>(output);
+    }
+};
+
+struct DataProcessedEvent
+{
+    std::string processedData;
+    std::string strategyName;
+};
+
+using DataProcessedEventPtr = std::shared_ptr<const DataProcessedEvent>;
+
+struct SubscriberOptions
+{
+    size_t queueCapacity = 1024;
+    QueueFullPolicy policy = QueueFullPolicy::Block;
+    size_t maxBatch = 64;
+};
+
+class DataPublisher
+{
+public:
+    using DataProcessedHandler = std::function<void(const std::string&, const std::string&)>;
+    using DataProcessedBatchHandler = std::function<void(std::span<const DataProcessedEventPtr>)>;
+
+private:
+    // Exactly one of eventHandler and batchHandler is set. Queued events are shared by every
+    // subscriber they were published to.
+    class Subscription
+    {
+    private:
+        DataProcessedHandler eventHandler;
+        DataProcessedBatchHandler batchHandler;
+        SubscriberOptions options;
+
+        std::mutex mutex;
+        std::condition_variable notFull;
+        std::vector<DataProcessedEventPtr> ring;
+        size_t head = 0;
+        size_t count = 0;
+        bool scheduled = false;
+
+        std::atomic<size_t> droppedEvents{0};
+        std::atomic<size_t> acceptedEvents{0};
+        std::atomic<size_t> deliveredEvents{0};
+        size_t reportedDrops = 0;
+
+    public:
+        Subscription(DataProcessedHandler handler, DataProcessedBatchHandler batchEventHandler,
+                     const SubscriberOptions& subscriberOptions)
+            : eventHandler(std::move(handler)), batchHandler(std::move(batchEventHandler)), options(subscriberOptions)
+        {
+            options.queueCapacity = std::max<size_t>(options.queueCapacity, 1);
+            options.maxBatch = std::max<size_t>(options.maxBatch, 1);
+            ring.resize(options.queueCapacity);
+        }
+
+        void Deliver(std::span<const DataProcessedEventPtr> events) const
+        {
+            if (!eventHandler)
+            {
+                batchHandler(events);
+                return;
+            }
+
+            for (const auto& event : events)
+            {
+                eventHandler(event->processedData, event->strategyName);
+            }
+        }
+
+        // Synchronous delivery passes the publisher's strings straight through; the shared event
+        // is only built, once per publish, when a batch subscriber needs one.
+        void Deliver(const std::string& processedData, const std::string& strategyName, DataProcessedEventPtr& shared) const
+        {
+            if (eventHandler)
+            {
+                eventHandler(processedData, strategyName);
+                return;
+            }
+
+            if (!shared)
+            {
+                shared = std::make_shared<const DataProcessedEvent>(DataProcessedEvent{processedData, strategyName});
+            }
+            batchHandler(std::span<const DataProcessedEventPtr>(&shared, 1));
+        }
+
+        // Returns true when the subscription went from idle to pending and must be handed to a worker.
+        bool Enqueue(const DataProcessedEventPtr& event)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (count == options.queueCapacity)
+            {
+                if (options.policy != QueueFullPolicy::Block)
+                {
+                    droppedEvents.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+
+                notFull.wait(lock, [this]() { return count < options.queueCapacity; });
+            }
+
+            ring[(head + count) % ring.size()] = event;
+            ++count;
+            acceptedEvents.fetch_add(1, std::memory_order_relaxed);
+
+            const bool wasIdle = !scheduled;
+            scheduled = true;
+            return wasIdle;
+        }
+
+        // Moves up to maxBatch events into batch and returns false when the queue is drained,
+        // in which case the subscription is no longer scheduled.
+        bool TakeBatch(std::vector<DataProcessedEventPtr>& batch)
+        {
+            batch.clear();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (count == 0)
+            {
+                scheduled = false;
+                return false;
+            }
+
+            const size_t taken = std::min(count, options.maxBatch);
+            for (size_t i = 0; i < taken; ++i)
+            {
+                batch.push_back(std::move(ring[head]));
+                head = (head + 1) % ring.size();
+            }
+            count -= taken;
+            notFull.notify_all();
+            return true;
+        }
+
+        void MarkDelivered(size_t events)
+        {
+            deliveredEvents.fetch_add(events, std::memory_order_release);
+        }
+
+        size_t TakeUnreportedDrops()
+        {
+            if (options.policy != QueueFullPolicy::DropAndCount)
+            {
+                return 0;
+            }
+
+            const size_t dropped = droppedEvents.load(std::memory_order_relaxed);
+            const size_t unreported = dropped - reportedDrops;
+            reportedDrops = dropped;
+            return unreported;
+        }
+
+        bool IsIdle() const
+        {
+            return deliveredEvents.load(std::memory_order_acquire) == acceptedEvents.load(std::memory_order_relaxed);
+        }
+
+        size_t GetDroppedCount() const
+        {
+            return droppedEvents.load(std::memory_order_relaxed);
+        }
+    };
+
+    std::vector<std::unique_ptr<Subscription>> subscribers;
+
+    mutable std::mutex readyMutex;
+    mutable std::condition_variable readyChanged;
+    mutable std::deque<Subscription*> ready;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    void Schedule(Subscription* subscription) const
+    {
+        {
+            std::lock_guard<std::mutex> lock(readyMutex);
+            ready.push_back(subscription);
+        }
+        readyChanged.notify_one();
+    }
+
+    void RunWorker()
+    {
+        std::vector<DataProcessedEventPtr> batch;
+        while (true)
+        {
+            Subscription* subscription;
+            {
+                std::unique_lock<std::mutex> lock(readyMutex);
+                readyChanged.wait(lock, [this]() { return stopping || !ready.empty(); });
+                if (ready.empty())
+                {
+                    return;
+                }
+
+                subscription = ready.front();
+                ready.pop_front();
+            }
+
+            // One batch per turn keeps a busy subscriber from starving the others on the pool.
+            if (!subscription->TakeBatch(batch))
+            {
+                continue;
+            }
+
+            try
+            {
+                subscription->Deliver(batch);
+            }
+            catch (const std::exception& error)
+            {
+                static const LogFormat format("data publisher subscriber failed: {}");
+                LoggerManager::GetInstance().LogFormatted<LogLevel::Error>(format, error.what());
+            }
+            catch (...)
+            {
+                static const LogFormat format("data publisher subscriber failed with a non-standard exception");
+                LoggerManager::GetInstance().LogFormatted<LogLevel::Error>(format);
+            }
+            subscription->MarkDelivered(batch.size());
+            batch.clear();
+
+            if (const size_t dropped = subscription->TakeUnreportedDrops())
+            {
+                static const LogFormat format("data publisher subscriber dropped {} events");
+                LoggerManager::GetInstance().LogFormatted<LogLevel::Warning>(format, dropped);
+            }
+
+            Schedule(subscription);
+        }
+    }
+
+    void DeliverNow(const std::string& processedData, const std::string& strategyName) const
+    {
+        DataProcessedEventPtr shared;
+        for (const auto& subscriber : subscribers)
+        {
+            subscriber->Deliver(processedData, strategyName, shared);
+        }
+    }
+
+    void EnqueueAll(const DataProcessedEventPtr& event) const
+    {
+        for (const auto& subscriber : subscribers)
+        {
+            if (subscriber->Enqueue(event))
+            {
+                Schedule(subscriber.get());
+            }
+        }
+    }
+
+    void StopWorkers()
+    {
+        if (workers.empty())
+        {
+            return;
+        }
+
+        Flush();
+        {
+            std::lock_guard<std::mutex> lock(readyMutex);
+            stopping = true;
+        }
+        readyChanged.notify_all();
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        workers.clear();
+        ready.clear();
+        stopping = false;
+    }
+
+public:
+    DataPublisher() = default;
+    DataPublisher(const DataPublisher&) = delete;
+    DataPublisher& operator=(const DataPublisher&) = delete;
+
+    ~DataPublisher()
+    {
+        StopWorkers();
+    }
+
+    void Subscribe(const DataProcessedHandler& handler, const SubscriberOptions& options = {})
+    {
+        subscribers.push_back(std::make_unique<Subscription>(handler, nullptr, options));
+    }
+
+    void SubscribeBatch(const DataProcessedBatchHandler& handler, const SubscriberOptions& options = {})
+    {
+        subscribers.push_back(std::make_unique<Subscription>(nullptr, handler, options));
+    }
+
+    // Subscribing and switching modes must not race with PublishDataProcessed. A Block subscriber
+    // that publishes from its own handler can deadlock once its queue is full.
+    void SetAsyncMode(bool enabled, size_t workerCount = 2)
+    {
+        StopWorkers();
+        if (!enabled)
+        {
+            return;
+        }
+
+        for (size_t i = 0; i < std::max<size_t>(workerCount, 1); ++i)
+        {
+            workers.emplace_back([this]() { RunWorker(); });
+        }
+    }
+
+    void PublishDataProcessed(const std::string& processedData, const std::string& strategyName) const
+    {
+        if (workers.empty())
+        {
+            DeliverNow(processedData, strategyName);
+            return;
+        }
+
+        EnqueueAll(std::make_shared<const DataProcessedEvent>(DataProcessedEvent{processedData, strategyName}));
+    }
+
+    // Takes over the payload, so asynchronous publishing does not copy it at all.
+    void PublishDataProcessed(std::string&& processedData, const std::string& strategyName) const
+    {
+        if (workers.empty())
+        {
+            DeliverNow(processedData, strategyName);
+            return;
+        }
+
+        EnqueueAll(std::make_shared<const DataProcessedEvent>(DataProcessedEvent{std::move(processedData), strategyName}));
+    }
+
+    void Flush() const
+    {
+        for (const auto& subscriber : subscribers)
+        {
+            while (!subscriber->IsIdle())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    size_t GetDroppedCount(size_t subscriberIndex) const
+    {
+        return subscribers.at(subscriberIndex)->GetDroppedCount();
+    }
+};
+
+class ProcessingLoggerObserver
+{
+public:
+    void OnDataProcessed(const std::string& processedData, const std::string& strategyName) const
+    {
+        static const LogFormat format("observer received processed data, strategy={}, data={}");
+        LoggerManager::GetInstance().LogFormatted(format, strategyName, processedData);
+    }
+};
+
+void RunProcessingScenario(
+    const std::string& scenarioTitle,
+    DataContext& context,
+    const DataPublisher& publisher,
+    const std::string& input)
+{
+    std::cout << "\n========== " << scenarioTitle << " ==========" << std::endl;
+
+    const std::string processed = context.ProcessData(input);
+    static const LogFormat format("data processed in context, input={}, output={}");
+    LoggerManager::GetInstance().LogFormatted(format, input, processed);
+    publisher.PublishDataProcessed(processed, context.GetStrategyName());
+}
+
+std::string GenerateCodecCorpus(const std::string& kind, size_t size)
+{
+    static const char* words[] = {"strategy", "observer", "logger", "factory", "data", "processed", "context",
+                                  "publisher", "singleton", "record", "the", "a", "of", "and"};
+
+    std::mt19937 random(25);
+    std::string corpus;
+    corpus.reserve(size + 64);
+    while (corpus.size() < size)
+    {
+        if (kind == "text")
+        {
+            corpus += words[random() % std::size(words)];
+            corpus += (random() % 12 == 0) ? '\n' : ' ';
+        }
+        else if (kind == "runs")
+        {
+            corpus.append(1 + random() % 40, static_cast<char>('a' + random() % 26));
+        }
+        else if (kind == "log")
+        {
+            corpus += "[filelogger] data processed in context, input=payload_" + std::to_string(random() % 1000) +
+                      ", output=" + std::to_string(random()) + "\n";
+        }
+        else
+        {
+            corpus.push_back(static_cast<char>(random()));
+        }
+    }
+
+    corpus.resize(size);
+    return corpus;
+}
+
+bool BenchmarkCodec(const std::string& name, const std::string& input)
+{
+    using Clock = std::chrono::steady_clock;
+
+    LzCodecDataStrategy codec;
+    const int repeats = static_cast<int>(std::max<size_t>(1, (16 * 1024 * 1024) / std::max<size_t>(input.size(), 1)));
+
+    std::string encoded;
+    auto start = Clock::now();
+    for (int i = 0; i < repeats; ++i)
+    {
+        encoded = codec.Process(input);
+    }
+    const double encodeSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::string decoded;
+    start = Clock::now();
+    for (int i = 0; i < repeats; ++i)
+    {
+        decoded = LzCodecDataStrategy::Decode(encoded);
+    }
+    const double decodeSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const double megabytes = static_cast<double>(input.size()) * repeats / (1024.0 * 1024.0);
+    const bool roundTrip = decoded == input;
+    std::cout << std::fixed << std::setprecision(2) << std::setw(16) << std::left << name << std::right
+              << " size=" << std::setw(10) << input.size() << " encoded=" << std::setw(10) << encoded.size()
+              << " ratio=" << std::setw(6) << static_cast<double>(input.size()) / static_cast<double>(std::max<size_t>(encoded.size(), 1))
+              << " encode=" << std::setw(8) << megabytes / encodeSeconds << " MB/s"
+              << " decode=" << std::setw(8) << megabytes / decodeSeconds << " MB/s"
+              << " round trip=" << (roundTrip ? "ok" : "MISMATCH") << std::endl;
+
+    return roundTrip;
+}
+
+int RunCodecBenchmark(size_t megabytes)
+{
+    bool allPassed = true;
+    for (const char* sample : {"hellooo_worlld", "datta_111", "aaabbbcccc", "async_payload", "aaabbbccccdd_eee"})
+    {
+        allPassed = BenchmarkCodec(sample, sample) && allPassed;
+    }
+
+    for (const char* kind : {"text", "runs", "log", "random"})
+    {
+        allPassed = BenchmarkCodec(std::string("synthetic ") + kind, GenerateCodecCorpus(kind, megabytes * 1024 * 1024)) && allPassed;
+    }
+
+    return allPassed ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc == 3 && std::string(argv[1]) == "decode")
+    {
+        return BinaryFileLogger::Decode(argv[2], std::cout) ? 0 : 1;
+    }
+
+    if (argc >= 2 && std::string(argv[1]) == "bench")
+    {
+        return RunCodecBenchmark(argc >= 3 ? static_cast<size_t>(std::stoul(argv[2])) : 64);
+    }
+
+    EncryptDataStrategy encryptStrategy;
+    CompressDataStrategy compressStrategy;
+
+    DataContext context(&encryptStrategy);
+    DataPublisher publisher;
+    ProcessingLoggerObserver observer;
+
+    publisher.Subscribe(
+        [&observer](const std::string& processedData, const std::string& strategyName)
+        {
+            observer.OnDataProcessed(processedData, strategyName);
+        });
 
     LoggerManager::GetInstance().SetFactory(std::make_unique<ConsoleLoggerFactory>());
     RunProcessingScenario("scenario 1: full integration", context, publisher, "hellooo_worlld");
@@ -260,5 +2800,141 @@ int main()
     context.SetStrategy(&compressStrategy);
     RunProcessingScenario("scenario 3: dynamic strategy change - after switch", context, publisher, "aaabbbcccc");
 
+    LoggerManager::GetInstance().SetAsyncMode(true, 1024, QueueFullPolicy::DropAndCount);
+    RunProcessingScenario("scenario 4: asynchronous logging", context, publisher, "async_payload");
+    LoggerManager::GetInstance().Flush();
+
+    LoggerManager::GetInstance().SetFactory(std::make_unique<BinaryFileLoggerFactory>());
+    RunProcessingScenario("scenario 5: binary records, formatted offline", context, publisher, "binary_payload");
+    LoggerManager::GetInstance().SetAsyncMode(false);
+    LoggerManager::GetInstance().SetFactory(std::make_unique<ConsoleLoggerFactory>());
+
+    std::cout << "\n========== scenario 6: log levels and rate limiting ==========" << std::endl;
+    LoggerManager::GetInstance().SetMinimumLevel(LogLevel::Info);
+    LogRateLimiter progressLimiter(3, std::chrono::seconds(1));
+    for (int iteration = 0; iteration < 1000; ++iteration)
+    {
+        static const LogFormat debugFormat("hot loop iteration {}");
+        LoggerManager::GetInstance().LogFormatted<LogLevel::Debug>(debugFormat, iteration);
+
+        static const LogFormat progressFormat("hot loop progress, iteration={}");
+        LoggerManager::GetInstance().LogLimited<LogLevel::Warning>(progressLimiter, progressFormat, iteration);
+    }
+    std::cout << "debug records filtered by level, rate limiter suppressed "
+              << progressLimiter.GetSuppressedCount() << " warnings" << std::endl;
+
+    std::cout << "\n========== scenario 7: chunked strategy pipeline ==========" << std::endl;
+    DataPipeline pipeline(3);
+    pipeline.AddStage(&compressStrategy).AddStage(&encryptStrategy);
+    static const LogFormat pipelineFormat("pipeline {} over 3-byte chunks, input={}, output={}, whole-input output={}");
+    const std::string pipelineInput = "aaabbbccccdd_eee";
+    LoggerManager::GetInstance().LogFormatted(pipelineFormat, pipeline.GetName(), pipelineInput,
+                                              pipeline.Process(pipelineInput),
+                                              encryptStrategy.Process(compressStrategy.Process(pipelineInput)));
+
+    std::cout << "\n========== scenario 8: reversible lz codec ==========" << std::endl;
+    LzCodecDataStrategy codecStrategy;
+    std::string codecInput;
+    for (int i = 0; i < 200; ++i)
+    {
+        codecInput += "aaaabbbbcccc_payload_" + std::to_string(i % 10) + ';';
+    }
+    const std::string encoded = codecStrategy.Process(codecInput);
+    static const LogFormat codecFormat("{} encoded {} bytes into {} bytes, decoded back identical={}");
+    LoggerManager::GetInstance().LogFormatted(codecFormat, codecStrategy.GetName(), codecInput.size(), encoded.size(),
+                                              LzCodecDataStrategy::Decode(encoded) == codecInput ? "yes" : "no");
+
+    std::cout << "\n========== scenario 9: asynchronous publisher with a slow observer ==========" << std::endl;
+    {
+        DataPublisher asyncPublisher;
+        asyncPublisher.Subscribe(
+            [](const std::string&, const std::string&) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); },
+            SubscriberOptions{16, QueueFullPolicy::DropAndCount, 1});
+
+        size_t batchedEvents = 0;
+        size_t batches = 0;
+        asyncPublisher.SubscribeBatch(
+            [&batchedEvents, &batches](std::span<const DataProcessedEventPtr> events)
+            {
+                batchedEvents += events.size();
+                ++batches;
+            },
+            SubscriberOptions{4096, QueueFullPolicy::Block, 256});
+
+        asyncPublisher.SetAsyncMode(true, 2);
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 1000; ++i)
+        {
+            asyncPublisher.PublishDataProcessed(encryptStrategy.Process("event_" + std::to_string(i)), encryptStrategy.GetName());
+        }
+        const auto publishMicroseconds =
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        asyncPublisher.Flush();
+
+        std::cout << "published 1000 events in " << publishMicroseconds << " us, slow observer dropped "
+                  << asyncPublisher.GetDroppedCount(0) << ", batch observer got " << batchedEvents << " events in "
+                  << batches << " batches" << std::endl;
+    }
+
+    std::cout << "\n========== scenario 10: parallel context on a large payload ==========" << std::endl;
+    {
+        const std::string payload = GenerateCodecCorpus("runs", 32 * 1024 * 1024);
+        DataContext parallelContext(&compressStrategy);
+        parallelContext.SetParallelMode(std::max(2u, std::thread::hardware_concurrency()));
+
+        for (const IDataProcessorStrategy* strategy : {static_cast<const IDataProcessorStrategy*>(&encryptStrategy),
+                                                        static_cast<const IDataProcessorStrategy*>(&compressStrategy),
+                                                        static_cast<const IDataProcessorStrategy*>(&codecStrategy)})
+        {
+            parallelContext.SetStrategy(strategy);
+            const auto start = std::chrono::steady_clock::now();
+            const std::string parallelOutput = parallelContext.ProcessData(payload);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            std::cout << strategy->GetName() << ": " << std::fixed << std::setprecision(1) << 32.0 / seconds
+                      << " MB/s, matches sequential=" << (parallelOutput == strategy->Process(payload) ? "yes" : "no")
+                      << std::endl;
+        }
+    }
+
+    std::cout << "\n========== scenario 11: records longer than the inline buffer ==========" << std::endl;
+    bool recordsWhole = true;
+    {
+        auto messages = std::make_shared<std::vector<std::string>>();
+        const std::string longInput = GenerateCodecCorpus("text", 4 * LogRecordWriter::InlineRecordLength);
+        const std::string longOutput = encryptStrategy.Process(longInput);
+        const std::string expected = "data processed in context, input=" + longInput + ", output=" + longOutput;
+        static const LogFormat longFormat("data processed in context, input={}, output={}");
+
+        LoggerManager::GetInstance().SetFactory(std::make_unique<MemoryLoggerFactory>(messages));
+        LoggerManager::GetInstance().LogFormatted(longFormat, longInput, longOutput);
+        LoggerManager::GetInstance().Flush();
+        LoggerManager::GetInstance().SetFactory(std::make_unique<ConsoleLoggerFactory>());
+
+        const bool whole = messages->size() == 1 && messages->front() == expected;
+        recordsWhole = recordsWhole && whole;
+        std::cout << "sync record of " << expected.size() << " bytes came out whole=" << (whole ? "yes" : "no") << std::endl;
+
+        messages->clear();
+        LoggerManager::GetInstance().SetAsyncMode(true);
+        LoggerManager::GetInstance().SetFactory(std::make_unique<MemoryLoggerFactory>(messages));
+        LoggerManager::GetInstance().LogFormatted(longFormat, longInput, longOutput);
+        LoggerManager::GetInstance().Log(expected);
+        LoggerManager::GetInstance().Flush();
+        LoggerManager::GetInstance().SetAsyncMode(false);
+        LoggerManager::GetInstance().SetFactory(std::make_unique<ConsoleLoggerFactory>());
+
+        const bool asyncWhole = messages->size() == 2 && messages->front() == expected && messages->back() == expected;
+        recordsWhole = recordsWhole && asyncWhole;
+        std::cout << "async record and message of " << expected.size() << " bytes came out whole="
+                  << (asyncWhole ? "yes" : "no") << std::endl;
+    }
+
     std::cout << "\ndone, check console and lab25_log.txt for logger behavior changes" << std::endl;
+    const std::string binaryLogPath = BinaryFileLoggerFactory::DefaultPath();
+    std::cout << "binary records are in " << binaryLogPath << ", decode them with: lab25 decode " << binaryLogPath
+              << std::endl;
+    std::cout << "codec ratio and throughput: lab25 bench [megabytes]" << std::endl;
+
+    return recordsWhole ? 0 : 1;
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Item.h"
 #include <vector>
 #include <memory>
+#include <utility>
 
 class Character
 {
@@ -15,18 +16,23 @@ private:
 public:
     Character() : id(0), name(""), level(1) {}
 
-    Character(int id, const std::string& name, int level)
-        : id(id), name(name), level(level)
+    Character(int id, std::string name, int level)
+        : id(id), name(std::move(name)), level(level)
     {
     }
 
+    Character(const Character&) = default;
+    Character(Character&&) noexcept = default;
+    Character& operator=(const Character&) = default;
+    Character& operator=(Character&&) noexcept = default;
+
     int GetId() const { return id; }
-    std::string GetName() const { return name; }
+    const std::string& GetName() const { return name; }
     int GetLevel() const { return level; }
     const std::vector<Item>& GetInventory() const { return inventory; }
 
     void SetId(int newId) { id = newId; }
-    void SetName(const std::string& newName) { name = newName; }
+    void SetName(std::string newName) { name = std::move(newName); }
     void SetLevel(int newLevel) { level = newLevel; }
 
     void AddItem(const Item& item)
@@ -34,6 +40,22 @@ public:
         inventory.push_back(item);
     }
 
+    void AddItem(Item&& item)
+    {
+        inventory.push_back(std::move(item));
+    }
+
+    template <typename... Args>
+    Item& EmplaceItem(Args&&... args)
+    {
+        return inventory.emplace_back(std::forward<Args>(args)...);
+    }
+
+    void ReserveInventory(size_t capacity)
+    {
+        inventory.reserve(capacity);
+    }
+
     void ClearInventory()
     {
         inventory.clear();
@@ -44,5 +66,10 @@ public:
         inventory = newInventory;
     }
 
+    void SetInventory(std::vector<Item>&& newInventory)
+    {
+        inventory = std::move(newInventory);
+    }
+
     virtual ~Character() = default;
 };
\ No newline at end of file
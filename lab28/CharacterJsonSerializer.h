@@ -0,0 +1,163 @@
+#pragma once
+
+#include "Character.h"
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+class CharacterJsonSerializer
+{
+private:
+    static void AppendInt(std::string& out, int value)
+    {
+        char digits[16];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, result.ptr);
+    }
+
+    // A missing key yields fallback. A value that is not a number, or does not fit in an int, throws
+    // std::invalid_argument or std::out_of_range naming the key, as std::stoi did.
+    static int ParseInt(std::string_view json, std::string_view key, int fallback)
+    {
+        size_t pos = json.find(key);
+        if (pos == std::string_view::npos)
+            return fallback;
+
+        pos += key.size();
+        while (pos < json.size() && (json[pos] == ' ' || json[pos] == '\t' || json[pos] == '\n' || json[pos] == '\r'))
+            ++pos;
+        if (pos < json.size() && json[pos] == '+')
+            ++pos;
+
+        int value = fallback;
+        const auto [end, error] = std::from_chars(json.data() + pos, json.data() + json.size(), value);
+        if (error == std::errc::result_out_of_range)
+            throw std::out_of_range("JSON number out of range for key " + std::string(key));
+        if (error != std::errc())
+            throw std::invalid_argument("malformed JSON number for key " + std::string(key));
+
+        return value;
+    }
+
+    static std::string_view ParseString(std::string_view json, std::string_view key)
+    {
+        size_t start = json.find(key);
+        if (start == std::string_view::npos)
+            return {};
+
+        start += key.size();
+        size_t end = json.find('"', start);
+        return json.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+    }
+
+public:
+    void AppendItemJson(std::string& out, const Item& item) const
+    {
+        out += "{\"id\":";
+        AppendInt(out, item.GetId());
+        out += ",\"name\":\"";
+        out += item.GetName();
+        out += "\",\"type\":\"";
+        out += item.GetType();
+        out += "\",\"power\":";
+        AppendInt(out, item.GetPower());
+        out += '}';
+    }
+
+    void AppendCharacterJson(std::string& out, const Character& character) const
+    {
+        out += "{\"id\":";
+        AppendInt(out, character.GetId());
+        out += ",\"name\":\"";
+        out += character.GetName();
+        out += "\",\"level\":";
+        AppendInt(out, character.GetLevel());
+        out += ",\"inventory\":[";
+
+        const auto& inventory = character.GetInventory();
+        for (size_t i = 0; i < inventory.size(); ++i)
+        {
+            AppendItemJson(out, inventory[i]);
+            if (i < inventory.size() - 1) out += ',';
+        }
+
+        out += "]}";
+    }
+
+    std::string ItemToJson(const Item& item) const
+    {
+        std::string json;
+        AppendItemJson(json, item);
+        return json;
+    }
+
+    std::string CharacterToJson(const Character& character) const
+    {
+        std::string json;
+        AppendCharacterJson(json, character);
+        return json;
+    }
+
+    Item JsonToItem(std::string_view json) const
+    {
+        return Item(ParseInt(json, "\"id\":", 0),
+                    std::string(ParseString(json, "\"name\":\"")),
+                    std::string(ParseString(json, "\"type\":\"")),
+                    ParseInt(json, "\"power\":", 0));
+    }
+
+    Character JsonToCharacter(std::string_view json) const
+    {
+        Character character(ParseInt(json, "\"id\":", 0),
+                            std::string(ParseString(json, "\"name\":\"")),
+                            ParseInt(json, "\"level\":", 1));
+
+        size_t invStart = json.find("\"inventory\":[");
+        if (invStart != std::string_view::npos)
+        {
+            invStart += 13;
+            size_t invEnd = json.find(']', invStart);
+            std::string_view invJson = json.substr(invStart, invEnd == std::string_view::npos ? std::string_view::npos : invEnd - invStart);
+
+            size_t itemCount = 0;
+            for (char symbol : invJson)
+            {
+                if (symbol == '{') ++itemCount;
+            }
+            character.ReserveInventory(itemCount);
+
+            size_t pos = 0;
+            while (pos < invJson.length())
+            {
+                size_t itemStart = invJson.find('{', pos);
+                if (itemStart == std::string_view::npos) break;
+
+                size_t itemEnd = invJson.find('}', itemStart);
+                if (itemEnd == std::string_view::npos) break;
+
+                character.AddItem(JsonToItem(invJson.substr(itemStart, itemEnd - itemStart + 1)));
+                pos = itemEnd + 1;
+            }
+        }
+
+        return character;
+    }
+
+    static bool FindNextObject(std::string_view content, size_t from, size_t& objectStart, size_t& objectEnd)
+    {
+        objectStart = content.find('{', from);
+        if (objectStart == std::string_view::npos) return false;
+
+        size_t braceCount = 1;
+        objectEnd = objectStart + 1;
+        while (objectEnd < content.length() && braceCount > 0)
+        {
+            if (content[objectEnd] == '{') braceCount++;
+            if (content[objectEnd] == '}') braceCount--;
+            objectEnd++;
+        }
+
+        return true;
+    }
+};
\ No newline at end of file
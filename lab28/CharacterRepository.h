@@ -1,189 +1,179 @@
 #pragma once
 
 #include "Character.h"
+#include "CharacterJsonSerializer.h"
+#include "InventoryQuery.h"
+#include "RepositorySnapshot.h"
 #include <vector>
 #include <fstream>
 #include <iostream>
-#include <sstream>
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
 
 class CharacterRepository
 {
 private:
-    std::vector<Character> characters;
-
-    std::string ItemToJson(const Item& item) const
+    std::shared_ptr<CharacterStorage> characters = std::make_shared<CharacterStorage>();
+    std::uint64_t version = 0;
+    CharacterJsonSerializer serializer;
+    // Columns for Query(), rebuilt only when the version has moved since they were built.
+    mutable std::shared_ptr<const InventoryColumnStore> columnStore;
+    mutable std::uint64_t columnStoreVersion = 0;
+
+    template <typename T>
+    static bool IsShared(const std::shared_ptr<T>& pointer)
     {
-        std::ostringstream oss;
-        oss << "{\"id\":" << item.GetId()
-            << ",\"name\":\"" << item.GetName()
-            << "\",\"type\":\"" << item.GetType()
-            << "\",\"power\":" << item.GetPower() << "}";
-        return oss.str();
+        if (pointer.use_count() > 1)
+            return true;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return false;
     }
 
-    Item JsonToItem(const std::string& json) const
+    CharacterStorage& Mutable()
     {
-        Item item;
-        int id = 0, power = 0;
-        std::string name = "", type = "";
-
-        size_t idPos = json.find("\"id\":");
-        if (idPos != std::string::npos)
-        {
-            id = std::stoi(json.substr(idPos + 5));
-        }
+        ++version;
+        if (IsShared(characters))
+            characters = std::make_shared<CharacterStorage>(*characters);
 
-        size_t nameStart = json.find("\"name\":\"");
-        if (nameStart != std::string::npos)
-        {
-            nameStart += 8;
-            size_t nameEnd = json.find("\"", nameStart);
-            name = json.substr(nameStart, nameEnd - nameStart);
-        }
-
-        size_t typeStart = json.find("\"type\":\"");
-        if (typeStart != std::string::npos)
-        {
-            typeStart += 8;
-            size_t typeEnd = json.find("\"", typeStart);
-            type = json.substr(typeStart, typeEnd - typeStart);
-        }
+        return *characters;
+    }
 
-        size_t powerPos = json.find("\"power\":");
-        if (powerPos != std::string::npos)
-        {
-            power = std::stoi(json.substr(powerPos + 8));
-        }
+public:
+    // Each character costs one make_shared allocation (object and control block together) on top
+    // of its own inventory buffer and long strings.
+    void Add(const Character& character)
+    {
+        Mutable().push_back(std::make_shared<Character>(character));
+    }
 
-        item.SetId(id);
-        item.SetName(name);
-        item.SetType(type);
-        item.SetPower(power);
-        return item;
+    void Add(Character&& character)
+    {
+        Mutable().push_back(std::make_shared<Character>(std::move(character)));
     }
 
-    std::string CharacterToJson(const Character& character) const
+    template <typename... Args>
+    const Character& Emplace(Args&&... args)
     {
-        std::ostringstream oss;
-        oss << "{\"id\":" << character.GetId()
-            << ",\"name\":\"" << character.GetName()
-            << "\",\"level\":" << character.GetLevel()
-            << ",\"inventory\":[";
+        return *Mutable().emplace_back(std::make_shared<Character>(std::forward<Args>(args)...));
+    }
 
-        const auto& inventory = character.GetInventory();
-        for (size_t i = 0; i < inventory.size(); ++i)
-        {
-            oss << ItemToJson(inventory[i]);
-            if (i < inventory.size() - 1) oss << ",";
-        }
+    void Reserve(size_t capacity)
+    {
+        Mutable().reserve(capacity);
+    }
 
-        oss << "]}";
-        return oss.str();
+    // Iterates the characters in place. Code that needs a std::vector<Character> has to copy the range.
+    CharacterRange GetAll() const
+    {
+        return CharacterRange(characters.get());
     }
 
-    Character JsonToCharacter(const std::string& json) const
+    // Read-only lookup that does not change the version. The pointer stays valid until the next
+    // Update(), Clear() or load; changes go through Update() instead of the pointer.
+    const Character* GetById(int id) const
     {
-        Character character;
-        int id = 0, level = 1;
-        std::string name = "";
+        auto it = std::find_if(characters->begin(), characters->end(),
+                               [id](const std::shared_ptr<Character>& c) { return c->GetId() == id; });
 
-        size_t idPos = json.find("\"id\":");
-        if (idPos != std::string::npos)
-        {
-            id = std::stoi(json.substr(idPos + 5));
-        }
+        return it != characters->end() ? it->get() : nullptr;
+    }
 
-        size_t nameStart = json.find("\"name\":\"");
-        if (nameStart != std::string::npos)
-        {
-            nameStart += 8;
-            size_t nameEnd = json.find("\"", nameStart);
-            name = json.substr(nameStart, nameEnd - nameStart);
-        }
+    // Applies the change to a private copy and installs it, so snapshots and pointers from GetById()
+    // never observe a half-made change. Returns false if there is no such character or if the
+    // mutator changed the id, in which case the repository is left as it was.
+    template <typename Mutator>
+    bool Update(int id, Mutator&& mutate)
+    {
+        auto it = std::find_if(characters->begin(), characters->end(),
+                               [id](const std::shared_ptr<Character>& c) { return c->GetId() == id; });
 
-        size_t levelPos = json.find("\"level\":");
-        if (levelPos != std::string::npos)
-        {
-            level = std::stoi(json.substr(levelPos + 8));
-        }
+        if (it == characters->end())
+            return false;
 
-        character.SetId(id);
-        character.SetName(name);
-        character.SetLevel(level);
+        auto updated = std::make_shared<Character>(**it);
+        mutate(*updated);
+        if (updated->GetId() != id)
+            return false;
 
-        size_t invStart = json.find("\"inventory\":[");
-        if (invStart != std::string::npos)
-        {
-            invStart += 13;
-            size_t invEnd = json.find("]", invStart);
-            std::string invJson = json.substr(invStart, invEnd - invStart);
-
-            size_t pos = 0;
-            while (pos < invJson.length())
-            {
-                size_t itemStart = invJson.find("{", pos);
-                if (itemStart == std::string::npos) break;
-
-                size_t itemEnd = invJson.find("}", itemStart);
-                if (itemEnd == std::string::npos) break;
-
-                std::string itemStr = invJson.substr(itemStart, itemEnd - itemStart + 1);
-                character.AddItem(JsonToItem(itemStr));
-                pos = itemEnd + 1;
-            }
-        }
+        const size_t index = static_cast<size_t>(it - characters->begin());
+        Mutable()[index] = std::move(updated);
+        return true;
+    }
 
-        return character;
+    void Clear()
+    {
+        ++version;
+        characters = std::make_shared<CharacterStorage>();
     }
 
-public:
-    void Add(const Character& character)
+    RepositorySnapshot Snapshot() const
     {
-        characters.push_back(character);
+        return RepositorySnapshot(characters, version);
     }
 
-    const std::vector<Character>& GetAll() const
+    std::uint64_t GetVersion() const
     {
-        return characters;
+        return version;
     }
 
-    Character* GetById(int id)
+    InventoryQuery Query() const
     {
-        auto it = std::find_if(characters.begin(), characters.end(),
-                               [id](const Character& c) { return c.GetId() == id; });
+        if (!columnStore || columnStoreVersion != version)
+        {
+            columnStore = std::make_shared<const InventoryColumnStore>(GetAll());
+            columnStoreVersion = version;
+        }
 
-        if (it != characters.end())
-            return &(*it);
+        return InventoryQuery(columnStore->GetColumns(), columnStore);
+    }
 
-        return nullptr;
+    bool SaveToFile(const std::string& filename) const
+    {
+        return Snapshot().SaveToFile(filename);
     }
 
-    void Clear()
+    std::string ToJson() const
     {
-        characters.clear();
+        return Snapshot().ToJson();
     }
 
-    bool SaveToFile(const std::string& filename) const
+    std::future<bool> SaveToFileAsync(const std::string& filename) const
     {
-        std::ofstream file(filename);
-        if (!file.is_open())
+        return std::async(std::launch::async, [snapshot = Snapshot(), filename]() { return snapshot.SaveToFile(filename); });
+    }
+
+    void LoadFromJson(std::string_view content)
+    {
+        auto loaded = std::make_shared<CharacterStorage>();
+
+        size_t recordCount = 0, depth = 0;
+        for (char symbol : content)
         {
-            std::cerr << "Error: Could not open file " << filename << " for writing." << std::endl;
-            return false;
+            if (symbol == '{' && depth++ == 0) ++recordCount;
+            if (symbol == '}' && depth > 0) --depth;
         }
+        loaded->reserve(recordCount);
 
-        file << "[";
-        for (size_t i = 0; i < characters.size(); ++i)
+        size_t pos = 0;
+        while (pos < content.length())
         {
-            file << CharacterToJson(characters[i]);
-            if (i < characters.size() - 1) file << ",";
+            size_t charStart = 0, charEnd = 0;
+            if (!CharacterJsonSerializer::FindNextObject(content, pos, charStart, charEnd)) break;
+
+            loaded->push_back(std::make_shared<Character>(
+                serializer.JsonToCharacter(content.substr(charStart, charEnd - charStart))));
+            pos = charEnd;
         }
-        file << "]";
 
-        file.close();
-        std::cout << "Characters saved to " << filename << std::endl;
-        return true;
+        ++version;
+        characters = std::move(loaded);
     }
 
     bool LoadFromFile(const std::string& filename)
@@ -199,29 +189,17 @@ public:
                             std::istreambuf_iterator<char>());
         file.close();
 
-        characters.clear();
-
-        size_t pos = 0;
-        while (pos < content.length())
+        try
         {
-            size_t charStart = content.find("{", pos);
-            if (charStart == std::string::npos) break;
-
-            size_t braceCount = 1;
-            size_t charEnd = charStart + 1;
-            while (charEnd < content.length() && braceCount > 0)
-            {
-                if (content[charEnd] == '{') braceCount++;
-                if (content[charEnd] == '}') braceCount--;
-                charEnd++;
-            }
-
-            std::string charStr = content.substr(charStart, charEnd - charStart);
-            characters.push_back(JsonToCharacter(charStr));
-            pos = charEnd;
+            LoadFromJson(content);
+        }
+        catch (const std::exception& error)
+        {
+            std::cerr << "Error: Could not parse " << filename << ": " << error.what() << std::endl;
+            return false;
         }
 
-        std::cout << "Loaded " << characters.size() << " characters from " << filename << std::endl;
+        std::cout << "Loaded " << characters->size() << " characters from " << filename << std::endl;
         return true;
     }
 
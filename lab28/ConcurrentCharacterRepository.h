@@ -0,0 +1,268 @@
+#pragma once
+
+#include "CharacterJsonSerializer.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using CharacterHandle = std::shared_ptr<const Character>;
+
+class ConcurrentCharacterRepository
+{
+private:
+    using ShardMap = std::unordered_map<int, CharacterHandle>;
+
+    // A snapshot takes the map itself and marks it shared; the next writer copies it first, so
+    // taking a snapshot never has to copy under the lock. The flag is set under a shared lock by
+    // possibly several snapshots at once, hence atomic; writers read and clear it under the
+    // exclusive lock.
+    struct Shard
+    {
+        mutable std::shared_mutex mutex;
+        std::shared_ptr<ShardMap> characters = std::make_shared<ShardMap>();
+        mutable std::atomic<bool> shared{false};
+
+        ShardMap& Mutable()
+        {
+            if (shared.load(std::memory_order_relaxed))
+            {
+                characters = std::make_shared<ShardMap>(*characters);
+                shared.store(false, std::memory_order_relaxed);
+            }
+
+            return *characters;
+        }
+    };
+
+    size_t shardCount;
+    std::unique_ptr<Shard[]> shards;
+    CharacterJsonSerializer serializer;
+
+    Shard& ShardFor(int id) const
+    {
+        return shards[static_cast<size_t>(static_cast<unsigned int>(id)) % shardCount];
+    }
+
+public:
+    explicit ConcurrentCharacterRepository(size_t shardCount = 16)
+        : shardCount(shardCount > 0 ? shardCount : 1), shards(std::make_unique<Shard[]>(this->shardCount))
+    {
+    }
+
+    ConcurrentCharacterRepository(const ConcurrentCharacterRepository&) = delete;
+    ConcurrentCharacterRepository& operator=(const ConcurrentCharacterRepository&) = delete;
+
+    void Add(Character character)
+    {
+        const int id = character.GetId();
+        auto handle = std::make_shared<const Character>(std::move(character));
+
+        Shard& shard = ShardFor(id);
+        std::unique_lock lock(shard.mutex);
+        shard.Mutable().insert_or_assign(id, std::move(handle));
+    }
+
+    CharacterHandle GetById(int id) const
+    {
+        Shard& shard = ShardFor(id);
+        std::shared_lock lock(shard.mutex);
+
+        auto it = shard.characters->find(id);
+        return it != shard.characters->end() ? it->second : nullptr;
+    }
+
+    // The mutator works on a private copy outside the lock. Returns false if the character does not
+    // exist or if the mutator changed its id, which would file it under the wrong key.
+    template <typename Mutator>
+    bool Update(int id, Mutator&& mutate)
+    {
+        Shard& shard = ShardFor(id);
+
+        while (true)
+        {
+            CharacterHandle current;
+            {
+                std::shared_lock lock(shard.mutex);
+                auto it = shard.characters->find(id);
+                if (it == shard.characters->end())
+                    return false;
+                current = it->second;
+            }
+
+            auto updated = std::make_shared<Character>(*current);
+            mutate(*updated);
+            if (updated->GetId() != id)
+                return false;
+
+            std::unique_lock lock(shard.mutex);
+            auto it = shard.characters->find(id);
+            if (it == shard.characters->end())
+                return false;
+
+            if (it->second == current)
+            {
+                shard.Mutable()[id] = std::move(updated);
+                return true;
+            }
+        }
+    }
+
+    bool Remove(int id)
+    {
+        Shard& shard = ShardFor(id);
+        std::unique_lock lock(shard.mutex);
+        if (shard.characters->count(id) == 0)
+            return false;
+
+        return shard.Mutable().erase(id) > 0;
+    }
+
+    size_t Size() const
+    {
+        size_t total = 0;
+        for (size_t i = 0; i < shardCount; ++i)
+        {
+            std::shared_lock lock(shards[i].mutex);
+            total += shards[i].characters->size();
+        }
+
+        return total;
+    }
+
+    // All shards are locked together only long enough to take one pointer per shard, so writers
+    // wait O(shard count), not O(n); the handles are collected and sorted after the locks are gone.
+    std::vector<CharacterHandle> Snapshot() const
+    {
+        std::vector<std::shared_ptr<const ShardMap>> maps;
+        maps.reserve(shardCount);
+        {
+            std::vector<std::shared_lock<std::shared_mutex>> locks;
+            locks.reserve(shardCount);
+            for (size_t i = 0; i < shardCount; ++i)
+            {
+                locks.emplace_back(shards[i].mutex);
+            }
+
+            for (size_t i = 0; i < shardCount; ++i)
+            {
+                shards[i].shared.store(true, std::memory_order_relaxed);
+                maps.push_back(shards[i].characters);
+            }
+        }
+
+        size_t total = 0;
+        for (const auto& map : maps)
+        {
+            total += map->size();
+        }
+
+        std::vector<CharacterHandle> snapshot;
+        snapshot.reserve(total);
+        for (const auto& map : maps)
+        {
+            for (const auto& [id, handle] : *map)
+            {
+                snapshot.push_back(handle);
+            }
+        }
+
+        maps.clear();
+
+        std::sort(snapshot.begin(), snapshot.end(),
+                  [](const CharacterHandle& a, const CharacterHandle& b) { return a->GetId() < b->GetId(); });
+        return snapshot;
+    }
+
+    bool SaveToFile(const std::string& filename) const
+    {
+        const std::vector<CharacterHandle> snapshot = Snapshot();
+
+        std::ofstream file(filename);
+        if (!file.is_open())
+        {
+            std::cerr << "Error: Could not open file " << filename << " for writing." << std::endl;
+            return false;
+        }
+
+        std::string buffer;
+        file << "[";
+        for (size_t i = 0; i < snapshot.size(); ++i)
+        {
+            buffer.clear();
+            serializer.AppendCharacterJson(buffer, *snapshot[i]);
+            if (i < snapshot.size() - 1) buffer += ',';
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        }
+        file << "]";
+
+        file.close();
+        std::cout << "Characters saved to " << filename << std::endl;
+        return true;
+    }
+
+    // Parses straight into fresh shard maps and swaps them in, so readers see either the old or
+    // the new contents of each shard.
+    bool LoadFromFile(const std::string& filename)
+    {
+        std::ifstream file(filename);
+        if (!file.is_open())
+        {
+            std::cerr << "Error: Could not open file " << filename << " for reading." << std::endl;
+            return false;
+        }
+
+        const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        file.close();
+
+        std::vector<std::shared_ptr<ShardMap>> loaded(shardCount);
+        for (auto& map : loaded)
+        {
+            map = std::make_shared<ShardMap>();
+        }
+
+        size_t pos = 0;
+        try
+        {
+            while (pos < content.length())
+            {
+                size_t charStart = 0, charEnd = 0;
+                if (!CharacterJsonSerializer::FindNextObject(content, pos, charStart, charEnd))
+                    break;
+
+                auto handle = std::make_shared<const Character>(
+                    serializer.JsonToCharacter(std::string_view(content).substr(charStart, charEnd - charStart)));
+                const int id = handle->GetId();
+                loaded[static_cast<size_t>(static_cast<unsigned int>(id)) % shardCount]->insert_or_assign(id, std::move(handle));
+                pos = charEnd;
+            }
+        }
+        catch (const std::exception& error)
+        {
+            std::cerr << "Error: Could not parse " << filename << ": " << error.what() << std::endl;
+            return false;
+        }
+
+        std::vector<std::unique_lock<std::shared_mutex>> locks;
+        locks.reserve(shardCount);
+        for (size_t i = 0; i < shardCount; ++i)
+        {
+            locks.emplace_back(shards[i].mutex);
+            shards[i].characters = std::move(loaded[i]);
+            shards[i].shared.store(false, std::memory_order_relaxed);
+        }
+
+        return true;
+    }
+
+    virtual ~ConcurrentCharacterRepository() = default;
+};
\ No newline at end of file
@@ -0,0 +1,246 @@
+#pragma once
+
+#include "CharacterRepository.h"
+#include "InventoryArena.h"
+#include "InventoryQuery.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class FlatCharacterRepository;
+
+class ItemView
+{
+private:
+    const InventoryArena* arena;
+    size_t index;
+
+public:
+    ItemView(const InventoryArena* arena, size_t index) : arena(arena), index(index) {}
+
+    int GetId() const { return arena->GetIds()[index]; }
+    std::string_view GetName() const { return arena->GetName(index); }
+    const std::string& GetType() const { return arena->GetTypeName(arena->GetTypeIds()[index]); }
+    std::uint16_t GetTypeId() const { return arena->GetTypeIds()[index]; }
+    int GetPower() const { return arena->GetPowers()[index]; }
+
+    Item ToItem() const { return arena->MakeItem(index); }
+};
+
+template <typename Owner, typename View>
+class IndexIterator
+{
+private:
+    const Owner* owner;
+    size_t index;
+
+public:
+    IndexIterator(const Owner* owner, size_t index) : owner(owner), index(index) {}
+
+    View operator*() const { return View(owner, index); }
+    IndexIterator& operator++() { ++index; return *this; }
+    bool operator!=(const IndexIterator& other) const { return index != other.index; }
+};
+
+class InventoryRangeView
+{
+private:
+    const InventoryArena* arena;
+    size_t first;
+    size_t count;
+
+public:
+    using Iterator = IndexIterator<InventoryArena, ItemView>;
+
+    InventoryRangeView(const InventoryArena* arena, size_t first, size_t count)
+        : arena(arena), first(first), count(count)
+    {
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    ItemView operator[](size_t i) const { return ItemView(arena, first + i); }
+
+    Iterator begin() const { return Iterator(arena, first); }
+    Iterator end() const { return Iterator(arena, first + count); }
+};
+
+class CharacterView
+{
+private:
+    const FlatCharacterRepository* repository;
+    size_t index;
+
+public:
+    CharacterView(const FlatCharacterRepository* repository, size_t index)
+        : repository(repository), index(index)
+    {
+    }
+
+    int GetId() const;
+    const std::string& GetName() const;
+    int GetLevel() const;
+    InventoryRangeView GetInventory() const;
+
+    Character ToCharacter() const;
+};
+
+class FlatCharacterRepository
+{
+private:
+    std::vector<int> characterIds;
+    std::vector<int> levels;
+    std::vector<std::string> names;
+    std::vector<InventoryRange> ranges;
+    InventoryArena items;
+
+    friend class CharacterView;
+
+public:
+    using Iterator = IndexIterator<FlatCharacterRepository, CharacterView>;
+
+    void Add(const Character& character)
+    {
+        const auto& inventory = character.GetInventory();
+        const auto offset = static_cast<std::uint32_t>(items.Size());
+
+        // Items go in first and are rolled back if one is rejected, so a failed Add leaves no trace.
+        try
+        {
+            for (const auto& item : inventory)
+            {
+                items.Append(item);
+            }
+        }
+        catch (...)
+        {
+            items.Truncate(offset);
+            throw;
+        }
+
+        characterIds.push_back(character.GetId());
+        levels.push_back(character.GetLevel());
+        names.push_back(character.GetName());
+        ranges.push_back({offset, static_cast<std::uint32_t>(inventory.size())});
+    }
+
+    void Reserve(size_t characterCount, size_t itemCount)
+    {
+        characterIds.reserve(characterCount);
+        levels.reserve(characterCount);
+        names.reserve(characterCount);
+        ranges.reserve(characterCount);
+        items.Reserve(itemCount);
+    }
+
+    void Clear()
+    {
+        characterIds.clear();
+        levels.clear();
+        names.clear();
+        ranges.clear();
+        items.Clear();
+    }
+
+    size_t Size() const { return characterIds.size(); }
+    const InventoryArena& GetItems() const { return items; }
+
+    CharacterView operator[](size_t index) const { return CharacterView(this, index); }
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, Size()); }
+
+    std::optional<CharacterView> GetById(int id) const
+    {
+        for (size_t i = 0; i < characterIds.size(); ++i)
+        {
+            if (characterIds[i] == id)
+            {
+                return CharacterView(this, i);
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    long long SumPowerByType(const std::string& type) const
+    {
+        const int typeId = items.FindType(type);
+        if (typeId == InventoryArena::NoType)
+        {
+            return 0;
+        }
+
+        const std::uint16_t* typeIds = items.GetTypeIds().data();
+        const int* powers = items.GetPowers().data();
+        const size_t count = items.Size();
+
+        long long total = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            total += typeIds[i] == typeId ? powers[i] : 0;
+        }
+
+        return total;
+    }
+
+    InventoryQuery Query() const
+    {
+        return InventoryQuery({characterIds, levels, ranges, items.GetIds(), items.GetPowers(), items.GetTypeIds(),
+                               &items.GetTypeNames()});
+    }
+
+    static FlatCharacterRepository FromRepository(const CharacterRepository& repository)
+    {
+        FlatCharacterRepository flat;
+
+        size_t itemCount = 0;
+        for (const auto& character : repository.GetAll())
+        {
+            itemCount += character.GetInventory().size();
+        }
+
+        flat.Reserve(repository.GetAll().size(), itemCount);
+        for (const auto& character : repository.GetAll())
+        {
+            flat.Add(character);
+        }
+
+        return flat;
+    }
+
+    CharacterRepository ToRepository() const
+    {
+        CharacterRepository repository;
+        repository.Reserve(Size());
+        for (size_t i = 0; i < Size(); ++i)
+        {
+            repository.Add(CharacterView(this, i).ToCharacter());
+        }
+
+        return repository;
+    }
+};
+
+inline int CharacterView::GetId() const { return repository->characterIds[index]; }
+inline const std::string& CharacterView::GetName() const { return repository->names[index]; }
+inline int CharacterView::GetLevel() const { return repository->levels[index]; }
+
+inline InventoryRangeView CharacterView::GetInventory() const
+{
+    const auto& range = repository->ranges[index];
+    return InventoryRangeView(&repository->items, range.offset, range.length);
+}
+
+inline Character CharacterView::ToCharacter() const
+{
+    Character character(GetId(), GetName(), GetLevel());
+    character.ReserveInventory(GetInventory().size());
+    for (const auto& item : GetInventory())
+    {
+        character.AddItem(item.ToItem());
+    }
+
+    return character;
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Item.h"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct InventoryRange
+{
+    std::uint32_t offset;
+    std::uint32_t length;
+};
+
+class InventoryArena
+{
+private:
+    std::vector<int> ids;
+    std::vector<int> powers;
+    std::vector<std::uint16_t> typeIds;
+
+    std::string namePool;
+    std::vector<std::uint32_t> nameOffsets{0};
+
+    std::vector<std::string> typeNames;
+    std::unordered_map<std::string, std::uint16_t> typeLookup;
+
+public:
+    static constexpr int NoType = -1;
+
+    static constexpr size_t MaxTypeCount = size_t(UINT16_MAX) + 1;
+
+    // Type ids are 16-bit to keep the type column compact; a type past MaxTypeCount would alias
+    // an existing id, so it is rejected instead.
+    std::uint16_t InternType(const std::string& type)
+    {
+        auto it = typeLookup.find(type);
+        if (it != typeLookup.end())
+            return it->second;
+
+        if (typeNames.size() >= MaxTypeCount)
+            throw std::length_error("inventory arena supports at most 65536 distinct item types");
+
+        const auto typeId = static_cast<std::uint16_t>(typeNames.size());
+        typeNames.push_back(type);
+        typeLookup.emplace(type, typeId);
+        return typeId;
+    }
+
+    int FindType(const std::string& type) const
+    {
+        auto it = typeLookup.find(type);
+        return it != typeLookup.end() ? it->second : NoType;
+    }
+
+    const std::string& GetTypeName(std::uint16_t typeId) const { return typeNames[typeId]; }
+    const std::vector<std::string>& GetTypeNames() const { return typeNames; }
+    size_t GetTypeCount() const { return typeNames.size(); }
+
+    size_t Append(const Item& item)
+    {
+        const std::uint16_t typeId = InternType(item.GetType());
+        ids.push_back(item.GetId());
+        powers.push_back(item.GetPower());
+        typeIds.push_back(typeId);
+
+        namePool += item.GetName();
+        nameOffsets.push_back(static_cast<std::uint32_t>(namePool.size()));
+        return ids.size() - 1;
+    }
+
+    void Reserve(size_t itemCount)
+    {
+        ids.reserve(itemCount);
+        powers.reserve(itemCount);
+        typeIds.reserve(itemCount);
+        nameOffsets.reserve(itemCount + 1);
+    }
+
+    // Drops the items appended after the first itemCount ones.
+    void Truncate(size_t itemCount)
+    {
+        ids.resize(itemCount);
+        powers.resize(itemCount);
+        typeIds.resize(itemCount);
+        namePool.resize(nameOffsets[itemCount]);
+        nameOffsets.resize(itemCount + 1);
+    }
+
+    void Clear()
+    {
+        ids.clear();
+        powers.clear();
+        typeIds.clear();
+        namePool.clear();
+        nameOffsets.assign(1, 0);
+        typeNames.clear();
+        typeLookup.clear();
+    }
+
+    size_t Size() const { return ids.size(); }
+
+    const std::vector<int>& GetIds() const { return ids; }
+    const std::vector<int>& GetPowers() const { return powers; }
+    const std::vector<std::uint16_t>& GetTypeIds() const { return typeIds; }
+
+    std::string_view GetName(size_t index) const
+    {
+        return std::string_view(namePool).substr(nameOffsets[index], nameOffsets[index + 1] - nameOffsets[index]);
+    }
+
+    Item MakeItem(size_t index) const
+    {
+        return Item(ids[index], std::string(GetName(index)), typeNames[typeIds[index]], powers[index]);
+    }
+};
\ No newline at end of file
@@ -0,0 +1,297 @@
+#pragma once
+
+#include "Character.h"
+#include "InventoryArena.h"
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct InventoryColumns
+{
+    std::span<const int> characterIds;
+    std::span<const int> levels;
+    std::span<const InventoryRange> ranges;
+    std::span<const int> itemIds;
+    std::span<const int> powers;
+    std::span<const std::uint16_t> typeIds;
+    const std::vector<std::string>* typeNames = nullptr;
+};
+
+class InventoryColumnStore
+{
+private:
+    std::vector<int> characterIds;
+    std::vector<int> levels;
+    std::vector<InventoryRange> ranges;
+    std::vector<int> itemIds;
+    std::vector<int> powers;
+    std::vector<std::uint16_t> typeIds;
+    std::vector<std::string> typeNames;
+
+public:
+    template <typename CharacterRange>
+    explicit InventoryColumnStore(const CharacterRange& characters)
+    {
+        size_t itemCount = 0;
+        for (const auto& character : characters)
+        {
+            itemCount += character.GetInventory().size();
+        }
+
+        characterIds.reserve(characters.size());
+        levels.reserve(characters.size());
+        ranges.reserve(characters.size());
+        itemIds.reserve(itemCount);
+        powers.reserve(itemCount);
+        typeIds.reserve(itemCount);
+
+        std::unordered_map<std::string, std::uint16_t> typeLookup;
+        for (const auto& character : characters)
+        {
+            const auto& inventory = character.GetInventory();
+
+            characterIds.push_back(character.GetId());
+            levels.push_back(character.GetLevel());
+            ranges.push_back({static_cast<std::uint32_t>(itemIds.size()), static_cast<std::uint32_t>(inventory.size())});
+
+            for (const auto& item : inventory)
+            {
+                auto [it, inserted] = typeLookup.try_emplace(item.GetType(), static_cast<std::uint16_t>(typeNames.size()));
+                if (inserted)
+                {
+                    if (typeNames.size() >= InventoryArena::MaxTypeCount)
+                        throw std::length_error("inventory columns support at most 65536 distinct item types");
+                    typeNames.push_back(it->first);
+                }
+
+                itemIds.push_back(item.GetId());
+                powers.push_back(item.GetPower());
+                typeIds.push_back(it->second);
+            }
+        }
+    }
+
+    InventoryColumns GetColumns() const
+    {
+        return {characterIds, levels, ranges, itemIds, powers, typeIds, &typeNames};
+    }
+};
+
+struct PowerAggregate
+{
+    size_t count = 0;
+    long long sum = 0;
+    int min = INT_MAX;
+    int max = INT_MIN;
+
+    void Add(int power)
+    {
+        ++count;
+        sum += power;
+        min = std::min(min, power);
+        max = std::max(max, power);
+    }
+};
+
+struct ItemMatch
+{
+    int characterId;
+    int itemId;
+    int power;
+};
+
+class InventoryQuery
+{
+private:
+    InventoryColumns columns;
+    std::shared_ptr<const InventoryColumnStore> storage;
+
+    int minLevel = INT_MIN;
+    int maxLevel = INT_MAX;
+    int minPower = INT_MIN;
+    int maxPower = INT_MAX;
+    bool filterByType = false;
+    std::vector<std::uint8_t> allowedTypes;
+
+    template <typename Callback>
+    void ForEachCharacterMatch(Callback&& callback) const
+    {
+        const std::uint8_t* allowed = allowedTypes.data();
+        const bool anyType = !filterByType;
+        const int* powers = columns.powers.data();
+        const std::uint16_t* typeIds = columns.typeIds.data();
+
+        for (size_t c = 0; c < columns.ranges.size(); ++c)
+        {
+            const int level = columns.levels[c];
+            if (level < minLevel || level > maxLevel)
+                continue;
+
+            const InventoryRange range = columns.ranges[c];
+            const size_t end = range.offset + range.length;
+            for (size_t i = range.offset; i < end; ++i)
+            {
+                const int power = powers[i];
+                const bool matches = (anyType || allowed[typeIds[i]]) & (power >= minPower) & (power <= maxPower);
+                if (matches)
+                    callback(c, i);
+            }
+        }
+    }
+
+public:
+    explicit InventoryQuery(const InventoryColumns& columns,
+                            std::shared_ptr<const InventoryColumnStore> storage = nullptr)
+        : columns(columns), storage(std::move(storage))
+    {
+    }
+
+    InventoryQuery& WhereLevelBetween(int minValue, int maxValue)
+    {
+        minLevel = std::max(minLevel, minValue);
+        maxLevel = std::min(maxLevel, maxValue);
+        return *this;
+    }
+
+    InventoryQuery& WherePowerBetween(int minValue, int maxValue)
+    {
+        minPower = std::max(minPower, minValue);
+        maxPower = std::min(maxPower, maxValue);
+        return *this;
+    }
+
+    InventoryQuery& WhereType(const std::string& type)
+    {
+        if (!filterByType)
+        {
+            allowedTypes.assign(columns.typeNames->size(), 0);
+            filterByType = true;
+        }
+
+        const auto& names = *columns.typeNames;
+        auto it = std::find(names.begin(), names.end(), type);
+        if (it != names.end())
+            allowedTypes[static_cast<size_t>(it - names.begin())] = 1;
+
+        return *this;
+    }
+
+    PowerAggregate Aggregate() const
+    {
+        const std::uint8_t* allowed = allowedTypes.data();
+        const bool anyType = !filterByType;
+        const int* powers = columns.powers.data();
+        const std::uint16_t* typeIds = columns.typeIds.data();
+
+        PowerAggregate result;
+        for (size_t c = 0; c < columns.ranges.size(); ++c)
+        {
+            const int level = columns.levels[c];
+            if (level < minLevel || level > maxLevel)
+                continue;
+
+            const InventoryRange range = columns.ranges[c];
+            const size_t end = range.offset + range.length;
+
+            size_t count = 0;
+            long long sum = 0;
+            int min = INT_MAX;
+            int max = INT_MIN;
+            for (size_t i = range.offset; i < end; ++i)
+            {
+                const int power = powers[i];
+                const bool matches = (anyType || allowed[typeIds[i]]) & (power >= minPower) & (power <= maxPower);
+                count += matches;
+                sum += matches ? power : 0;
+                min = std::min(min, matches ? power : INT_MAX);
+                max = std::max(max, matches ? power : INT_MIN);
+            }
+
+            result.count += count;
+            result.sum += sum;
+            result.min = std::min(result.min, min);
+            result.max = std::max(result.max, max);
+        }
+
+        return result;
+    }
+
+    size_t Count() const { return Aggregate().count; }
+    long long SumPower() const { return Aggregate().sum; }
+
+    std::vector<ItemMatch> TopByPower(size_t k) const
+    {
+        std::vector<ItemMatch> top;
+        if (k == 0)
+            return top;
+
+        auto weaker = [](const ItemMatch& a, const ItemMatch& b) { return a.power > b.power; };
+        top.reserve(k + 1);
+
+        ForEachCharacterMatch([&](size_t c, size_t i)
+        {
+            const int power = columns.powers[i];
+            if (top.size() == k && power <= top.front().power)
+                return;
+
+            top.push_back({columns.characterIds[c], columns.itemIds[i], power});
+            std::push_heap(top.begin(), top.end(), weaker);
+            if (top.size() > k)
+            {
+                std::pop_heap(top.begin(), top.end(), weaker);
+                top.pop_back();
+            }
+        });
+
+        std::sort_heap(top.begin(), top.end(), weaker);
+        return top;
+    }
+
+    std::vector<std::pair<std::string, PowerAggregate>> GroupByType() const
+    {
+        std::vector<PowerAggregate> groups(columns.typeNames->size());
+        ForEachCharacterMatch([&](size_t, size_t i) { groups[columns.typeIds[i]].Add(columns.powers[i]); });
+
+        std::vector<std::pair<std::string, PowerAggregate>> result;
+        for (size_t t = 0; t < groups.size(); ++t)
+        {
+            if (groups[t].count > 0)
+                result.emplace_back((*columns.typeNames)[t], groups[t]);
+        }
+
+        return result;
+    }
+
+    std::map<int, PowerAggregate> GroupByLevelBucket(int bucketSize) const
+    {
+        std::map<int, PowerAggregate> result;
+        if (bucketSize <= 0)
+            return result;
+
+        size_t lastCharacter = SIZE_MAX;
+        PowerAggregate* group = nullptr;
+        ForEachCharacterMatch([&](size_t c, size_t i)
+        {
+            if (c != lastCharacter)
+            {
+                const int level = columns.levels[c];
+                const int bucket = (level >= 0 ? level / bucketSize : (level - bucketSize + 1) / bucketSize) * bucketSize;
+                group = &result[bucket];
+                lastCharacter = c;
+            }
+
+            group->Add(columns.powers[i]);
+        });
+
+        return result;
+    }
+};
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <utility>
 
 class Item
 {
@@ -13,19 +14,24 @@ private:
 public:
     Item() : id(0), name(""), type(""), power(0) {}
 
-    Item(int id, const std::string& name, const std::string& type, int power)
-        : id(id), name(name), type(type), power(power)
+    Item(int id, std::string name, std::string type, int power)
+        : id(id), name(std::move(name)), type(std::move(type)), power(power)
     {
     }
 
+    Item(const Item&) = default;
+    Item(Item&&) noexcept = default;
+    Item& operator=(const Item&) = default;
+    Item& operator=(Item&&) noexcept = default;
+
     int GetId() const { return id; }
-    std::string GetName() const { return name; }
-    std::string GetType() const { return type; }
+    const std::string& GetName() const { return name; }
+    const std::string& GetType() const { return type; }
     int GetPower() const { return power; }
 
     void SetId(int newId) { id = newId; }
-    void SetName(const std::string& newName) { name = newName; }
-    void SetType(const std::string& newType) { type = newType; }
+    void SetName(std::string newName) { name = std::move(newName); }
+    void SetType(std::string newType) { type = std::move(newType); }
     void SetPower(int newPower) { power = newPower; }
 
     virtual ~Item() = default;
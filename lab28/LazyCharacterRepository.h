@@ -0,0 +1,266 @@
+#pragma once
+
+#include "CharacterJsonSerializer.h"
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using CachedCharacter = std::shared_ptr<const Character>;
+
+class LazyCharacterRepository
+{
+private:
+    struct RecordLocation
+    {
+        std::uint64_t offset;
+        std::uint64_t length;
+    };
+
+    // Where the indexer is inside the current record's top-level object.
+    enum class KeyState
+    {
+        ExpectKey,
+        InKey,
+        ExpectColon,
+        InValue
+    };
+
+    std::ifstream file;
+    std::unordered_map<int, RecordLocation> index;
+    std::vector<int> ids;
+    size_t skippedRecords = 0;
+
+    size_t cacheCapacity;
+    std::list<std::pair<int, CachedCharacter>> cache;
+    std::unordered_map<int, std::list<std::pair<int, CachedCharacter>>::iterator> cacheLookup;
+    CharacterJsonSerializer serializer;
+
+    void IndexRecord(std::uint64_t start, std::uint64_t end, const std::string& idText)
+    {
+        int id = 0;
+        const char* first = idText.data();
+        const char* last = first + idText.size();
+        const auto [parsedEnd, error] = std::from_chars(first, last, id);
+        if (idText.empty() || error != std::errc() || parsedEnd != last)
+        {
+            ++skippedRecords;
+            return;
+        }
+
+        if (index.emplace(id, RecordLocation{start, end - start}).second)
+            ids.push_back(id);
+    }
+
+    // Returns nullptr when the record can no longer be read as indexed, e.g. the file was
+    // truncated or rewritten after Open().
+    CachedCharacter ReadRecord(int id, const RecordLocation& location)
+    {
+        std::string json(location.length, '\0');
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(location.offset));
+        file.read(json.data(), static_cast<std::streamsize>(location.length));
+        if (static_cast<std::uint64_t>(file.gcount()) != location.length)
+        {
+            std::cerr << "Error: Could not read record " << id << ", the file changed since it was indexed." << std::endl;
+            return nullptr;
+        }
+
+        CachedCharacter character;
+        try
+        {
+            character = std::make_shared<const Character>(serializer.JsonToCharacter(json));
+        }
+        catch (const std::exception& error)
+        {
+            std::cerr << "Error: Could not parse record " << id << ": " << error.what() << std::endl;
+            return nullptr;
+        }
+
+        if (character->GetId() != id)
+        {
+            std::cerr << "Error: Record at the indexed offset of " << id << " has id " << character->GetId()
+                      << ", the file changed since it was indexed." << std::endl;
+            return nullptr;
+        }
+
+        return character;
+    }
+
+public:
+    explicit LazyCharacterRepository(size_t cacheCapacity = 64)
+        : cacheCapacity(cacheCapacity > 0 ? cacheCapacity : 1)
+    {
+    }
+
+    bool Open(const std::string& filename)
+    {
+        file.close();
+        file.clear();
+        index.clear();
+        ids.clear();
+        skippedRecords = 0;
+        cache.clear();
+        cacheLookup.clear();
+
+        file.open(filename, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cerr << "Error: Could not open file " << filename << " for reading." << std::endl;
+            return false;
+        }
+
+        // Tracks strings, escapes and nesting so that braces inside names and keys of nested
+        // objects are ignored; only the "id" key of each record's top-level object is captured.
+        std::vector<char> buffer(64 * 1024);
+        std::uint64_t position = 0;
+        std::uint64_t recordStart = 0;
+        size_t depth = 0;
+        size_t arrayDepth = 0;
+        bool inString = false;
+        bool escaped = false;
+        KeyState state = KeyState::ExpectKey;
+        bool readingId = false;
+        std::string key;
+        std::string idText;
+
+        while (file.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || file.gcount() > 0)
+        {
+            const size_t count = static_cast<size_t>(file.gcount());
+            for (size_t i = 0; i < count; ++i, ++position)
+            {
+                const char symbol = buffer[i];
+                const bool topLevel = depth == 1 && arrayDepth == 0;
+
+                if (inString)
+                {
+                    if (escaped)
+                        escaped = false;
+                    else if (symbol == '\\')
+                        escaped = true;
+                    else if (symbol == '"')
+                        inString = false;
+
+                    if (topLevel && state == KeyState::InKey)
+                    {
+                        if (inString || escaped)
+                            key.push_back(symbol);
+                        else
+                            state = KeyState::ExpectColon;
+                    }
+
+                    continue;
+                }
+
+                if (symbol == '"')
+                {
+                    inString = true;
+                    if (topLevel && state == KeyState::ExpectKey)
+                    {
+                        state = KeyState::InKey;
+                        key.clear();
+                    }
+                    else if (topLevel && readingId)
+                    {
+                        // A quoted id is not a number; keeping the quote makes the record invalid.
+                        idText.push_back(symbol);
+                    }
+                }
+                else if (symbol == '{')
+                {
+                    if (depth++ == 0)
+                    {
+                        recordStart = position;
+                        arrayDepth = 0;
+                        state = KeyState::ExpectKey;
+                        readingId = false;
+                        idText.clear();
+                    }
+                }
+                else if (symbol == '}' && depth > 0)
+                {
+                    if (--depth == 0)
+                        IndexRecord(recordStart, position + 1, idText);
+                }
+                else if (depth > 0 && symbol == '[')
+                {
+                    ++arrayDepth;
+                }
+                else if (depth > 0 && symbol == ']' && arrayDepth > 0)
+                {
+                    --arrayDepth;
+                }
+                else if (topLevel && symbol == ':' && state == KeyState::ExpectColon)
+                {
+                    state = KeyState::InValue;
+                    readingId = key == "id";
+                    if (readingId)
+                        idText.clear();
+                }
+                else if (topLevel && symbol == ',')
+                {
+                    state = KeyState::ExpectKey;
+                    readingId = false;
+                }
+                else if (topLevel && readingId && !std::isspace(static_cast<unsigned char>(symbol)))
+                {
+                    idText.push_back(symbol);
+                }
+            }
+        }
+
+        std::cout << "Indexed " << ids.size() << " characters from " << filename;
+        if (skippedRecords > 0)
+            std::cout << " (skipped " << skippedRecords << " records without a valid id)";
+        std::cout << std::endl;
+        return true;
+    }
+
+    // Returns a shared read-only copy: it stays valid after eviction, and the repository does not
+    // write anything back, so there is no way to change the file through it.
+    CachedCharacter GetById(int id)
+    {
+        auto cached = cacheLookup.find(id);
+        if (cached != cacheLookup.end())
+        {
+            cache.splice(cache.begin(), cache, cached->second);
+            return cache.front().second;
+        }
+
+        auto location = index.find(id);
+        if (location == index.end())
+            return nullptr;
+
+        CachedCharacter character = ReadRecord(id, location->second);
+        if (!character)
+            return nullptr;
+
+        cache.emplace_front(id, std::move(character));
+        cacheLookup[id] = cache.begin();
+
+        if (cache.size() > cacheCapacity)
+        {
+            cacheLookup.erase(cache.back().first);
+            cache.pop_back();
+        }
+
+        return cache.front().second;
+    }
+
+    bool Contains(int id) const { return index.count(id) > 0; }
+    const std::vector<int>& GetIds() const { return ids; }
+    size_t Size() const { return ids.size(); }
+    size_t GetCachedCount() const { return cache.size(); }
+    size_t GetCacheCapacity() const { return cacheCapacity; }
+    size_t GetSkippedCount() const { return skippedRecords; }
+
+    virtual ~LazyCharacterRepository() = default;
+};
\ No newline at end of file
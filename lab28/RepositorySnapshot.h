@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Character.h"
+#include "CharacterJsonSerializer.h"
+#include "InventoryQuery.h"
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+using CharacterStorage = std::vector<std::shared_ptr<Character>>;
+
+class CharacterRange
+{
+private:
+    const CharacterStorage* storage;
+
+public:
+    class Iterator
+    {
+    private:
+        CharacterStorage::const_iterator current;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Character;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Character*;
+        using reference = const Character&;
+
+        Iterator() = default;
+        explicit Iterator(CharacterStorage::const_iterator current) : current(current) {}
+
+        reference operator*() const { return **current; }
+        pointer operator->() const { return current->get(); }
+        Iterator& operator++() { ++current; return *this; }
+        Iterator operator++(int) { Iterator copy = *this; ++current; return copy; }
+        bool operator==(const Iterator& other) const { return current == other.current; }
+        bool operator!=(const Iterator& other) const { return current != other.current; }
+    };
+
+    explicit CharacterRange(const CharacterStorage* storage) : storage(storage) {}
+
+    size_t size() const { return storage->size(); }
+    bool empty() const { return storage->empty(); }
+    const Character& operator[](size_t index) const { return *(*storage)[index]; }
+
+    Iterator begin() const { return Iterator(storage->begin()); }
+    Iterator end() const { return Iterator(storage->end()); }
+};
+
+class RepositorySnapshot
+{
+private:
+    std::shared_ptr<const CharacterStorage> characters;
+    std::uint64_t version;
+
+public:
+    RepositorySnapshot(std::shared_ptr<const CharacterStorage> characters, std::uint64_t version)
+        : characters(std::move(characters)), version(version)
+    {
+    }
+
+    CharacterRange GetAll() const { return CharacterRange(characters.get()); }
+    std::uint64_t GetVersion() const { return version; }
+
+    InventoryQuery Query() const
+    {
+        auto store = std::make_shared<const InventoryColumnStore>(GetAll());
+        return InventoryQuery(store->GetColumns(), store);
+    }
+
+    std::string ToJson() const
+    {
+        CharacterJsonSerializer serializer;
+        std::string json = "[";
+        for (size_t i = 0; i < characters->size(); ++i)
+        {
+            serializer.AppendCharacterJson(json, *(*characters)[i]);
+            if (i < characters->size() - 1) json += ',';
+        }
+        json += ']';
+        return json;
+    }
+
+    bool SaveToFile(const std::string& filename) const
+    {
+        std::ofstream file(filename);
+        if (!file.is_open())
+        {
+            std::cerr << "Error: Could not open file " << filename << " for writing." << std::endl;
+            return false;
+        }
+
+        CharacterJsonSerializer serializer;
+        std::string buffer;
+        file << "[";
+        for (size_t i = 0; i < characters->size(); ++i)
+        {
+            buffer.clear();
+            serializer.AppendCharacterJson(buffer, *(*characters)[i]);
+            if (i < characters->size() - 1) buffer += ',';
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        }
+        file << "]";
+
+        file.close();
+        std::cout << "Characters saved to " << filename << std::endl;
+        return true;
+    }
+};
\ No newline at end of file
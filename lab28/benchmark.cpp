@@ -0,0 +1,183 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+#include "CharacterRepository.h"
+
+namespace
+{
+    std::atomic<unsigned long long> allocationCount{0};
+}
+
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size))
+        return memory;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+CharacterRepository GenerateRoster(size_t characterCount, unsigned int seed)
+{
+    static const char* characterNames[] = {"Archer", "Warrior", "Mage", "Rogue", "Paladin", "Necromancer", "Druid"};
+    static const char* itemNames[] = {"Bow", "Sword", "Shield", "Staff", "Dagger", "Health Potion", "Mana Potion",
+                                      "Arrow Pack", "Plate Armor", "Ring of Swiftness"};
+    static const char* itemTypes[] = {"weapon", "armor", "consumable", "ammo", "trinket"};
+
+    std::mt19937 random(seed);
+    std::geometric_distribution<int> inventorySize(0.12);
+    std::uniform_int_distribution<int> level(1, 60);
+    std::uniform_int_distribution<int> power(0, 120);
+    std::uniform_int_distribution<size_t> characterName(0, std::size(characterNames) - 1);
+    std::uniform_int_distribution<size_t> itemName(0, std::size(itemNames) - 1);
+    std::uniform_int_distribution<size_t> itemType(0, std::size(itemTypes) - 1);
+
+    CharacterRepository repo;
+    repo.Reserve(characterCount);
+
+    int nextItemId = 1;
+    for (size_t i = 0; i < characterCount; ++i)
+    {
+        Character character(static_cast<int>(i + 1),
+                            std::string(characterNames[characterName(random)]) + std::to_string(i),
+                            level(random));
+
+        const int itemCount = std::min(inventorySize(random), 200);
+        character.ReserveInventory(static_cast<size_t>(itemCount));
+        for (int j = 0; j < itemCount; ++j)
+        {
+            character.EmplaceItem(nextItemId++, itemNames[itemName(random)], itemTypes[itemType(random)], power(random));
+        }
+
+        repo.Add(std::move(character));
+    }
+
+    return repo;
+}
+
+bool SameItems(const Character& left, const Character& right)
+{
+    const auto& a = left.GetInventory();
+    const auto& b = right.GetInventory();
+    if (a.size() != b.size())
+        return false;
+
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        if (a[i].GetId() != b[i].GetId() || a[i].GetName() != b[i].GetName() ||
+            a[i].GetType() != b[i].GetType() || a[i].GetPower() != b[i].GetPower())
+            return false;
+    }
+
+    return true;
+}
+
+bool SameRoster(const CharacterRepository& left, const CharacterRepository& right)
+{
+    const auto a = left.GetAll();
+    const auto b = right.GetAll();
+    if (a.size() != b.size())
+        return false;
+
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        if (a[i].GetId() != b[i].GetId() || a[i].GetName() != b[i].GetName() ||
+            a[i].GetLevel() != b[i].GetLevel() || !SameItems(a[i], b[i]))
+            return false;
+    }
+
+    return true;
+}
+
+bool RunBenchmark(size_t characterCount)
+{
+    using Clock = std::chrono::steady_clock;
+
+    const std::string filename = "benchmark_" + std::to_string(characterCount) + ".json";
+    CharacterRepository original = GenerateRoster(characterCount, 28);
+
+    size_t itemCount = 0;
+    for (const auto& character : original.GetAll())
+    {
+        itemCount += character.GetInventory().size();
+    }
+
+    auto allocationsBefore = allocationCount.load();
+    auto start = Clock::now();
+    if (!original.SaveToFile(filename))
+        return false;
+    const double saveSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    const auto saveAllocations = allocationCount.load() - allocationsBefore;
+
+    const double megabytes = static_cast<double>(std::filesystem::file_size(filename)) / (1024.0 * 1024.0);
+
+    CharacterRepository loaded;
+    allocationsBefore = allocationCount.load();
+    start = Clock::now();
+    if (!loaded.LoadFromFile(filename))
+        return false;
+    const double loadSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    const auto loadAllocations = allocationCount.load() - allocationsBefore;
+
+    const bool roundTrip = SameRoster(original, loaded);
+    std::filesystem::remove(filename);
+
+    const double perCharacter = static_cast<double>(characterCount);
+    std::cout << std::fixed << std::setprecision(2)
+              << "characters=" << characterCount << " items=" << itemCount << " size=" << megabytes << "MB" << std::endl
+              << "  save: " << megabytes / saveSeconds << " MB/s, "
+              << static_cast<double>(saveAllocations) / perCharacter << " allocations/character" << std::endl
+              << "  load: " << megabytes / loadSeconds << " MB/s, "
+              << static_cast<double>(loadAllocations) / perCharacter << " allocations/character" << std::endl
+              << "  round trip: " << (roundTrip ? "ok" : "MISMATCH") << std::endl;
+
+    return roundTrip;
+}
+
+// Default sizes go up to 1e7 characters, which needs several GB of memory (the roster plus the
+// reloaded copy); --quick stops at 1e6.
+int main(int argc, char* argv[])
+{
+    std::vector<size_t> sizes;
+    bool quick = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::string(argv[i]) == "--quick")
+            quick = true;
+        else
+            sizes.push_back(static_cast<size_t>(std::stod(argv[i])));
+    }
+
+    if (sizes.empty())
+    {
+        sizes = {1000, 10000, 100000, 1000000};
+        if (!quick)
+            sizes.push_back(10000000);
+    }
+
+    bool allPassed = true;
+    for (size_t size : sizes)
+    {
+        allPassed = RunBenchmark(size) && allPassed;
+    }
+
+    return allPassed ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "CharacterRepository.h"
+
+bool HasStructuralSymbols(const std::string& text)
+{
+    return text.find_first_of("{}[]\",") != std::string::npos;
+}
+
+bool IsRoundTripSafe(const CharacterRepository& repo)
+{
+    for (const auto& character : repo.GetAll())
+    {
+        if (HasStructuralSymbols(character.GetName()))
+            return false;
+
+        for (const auto& item : character.GetInventory())
+        {
+            if (HasStructuralSymbols(item.GetName()) || HasStructuralSymbols(item.GetType()))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    CharacterRepository repo;
+    try
+    {
+        repo.LoadFromJson(std::string_view(reinterpret_cast<const char*>(data), size));
+    }
+    catch (const std::invalid_argument&)
+    {
+        return 0;
+    }
+    catch (const std::out_of_range&)
+    {
+        return 0;
+    }
+
+    if (!IsRoundTripSafe(repo))
+        return 0;
+
+    const std::string firstPass = repo.ToJson();
+    CharacterRepository reloaded;
+    reloaded.LoadFromJson(firstPass);
+
+    if (reloaded.ToJson() != firstPass)
+    {
+        std::cerr << "round trip mismatch:\n" << firstPass << "\n" << reloaded.ToJson() << std::endl;
+        std::abort();
+    }
+
+    return 0;
+}
+
+#ifndef LAB28_LIBFUZZER
+std::string ReadFile(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+std::string Mutate(std::string input, std::mt19937& random)
+{
+    static const std::string tokens[] = {"{", "}", "[", "]", "\"", ":", ",", "\"id\":", "\"name\":\"",
+                                         "\"inventory\":[", "-", "99999999999", " "};
+
+    const int mutations = 1 + static_cast<int>(random() % 8);
+    for (int i = 0; i < mutations; ++i)
+    {
+        const size_t position = input.empty() ? 0 : random() % (input.size() + 1);
+        switch (random() % 4)
+        {
+        case 0:
+            if (!input.empty() && position < input.size()) input.erase(position, 1 + random() % 4);
+            break;
+        case 1:
+            input.insert(position, tokens[random() % std::size(tokens)]);
+            break;
+        case 2:
+            if (position < input.size()) input[position] = static_cast<char>(random() % 256);
+            break;
+        default:
+            if (!input.empty()) input.insert(position, input.substr(random() % input.size(), random() % 16));
+            break;
+        }
+    }
+
+    return input;
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> corpus;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::filesystem::path path(argv[i]);
+        if (std::filesystem::is_directory(path))
+        {
+            for (const auto& entry : std::filesystem::directory_iterator(path))
+            {
+                corpus.push_back(ReadFile(entry.path()));
+            }
+        }
+        else
+        {
+            corpus.push_back(ReadFile(path));
+        }
+    }
+
+    if (corpus.empty())
+        corpus.push_back("[{\"id\":1,\"name\":\"Archer\",\"level\":5,\"inventory\":[]}]");
+
+    for (const auto& input : corpus)
+    {
+        LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t*>(input.data()), input.size());
+    }
+
+    std::mt19937 random(28);
+    const int iterations = 200000;
+    for (int i = 0; i < iterations; ++i)
+    {
+        const std::string input = Mutate(corpus[random() % corpus.size()], random);
+        LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t*>(input.data()), input.size());
+    }
+
+    std::cout << "Ran " << corpus.size() << " corpus inputs and " << iterations << " mutations." << std::endl;
+    return 0;
+}
+#endif
\ No newline at end of file
@@ -1,7 +1,14 @@
+#include <future>
 #include <iostream>
+#include <thread>
+#include <utility>
 #include "CharacterRepository.h"
+#include "ConcurrentCharacterRepository.h"
+#include "FlatCharacterRepository.h"
+#include "LazyCharacterRepository.h"
 
-void PrintCharacter(const Character& character)
+template <typename CharacterType>
+void PrintCharacter(const CharacterType& character)
 {
     std::cout << "  ID: " << character.GetId()
               << " | Name: " << character.GetName()
@@ -23,21 +30,22 @@ int main()
 
     std::cout << "1. Creating characters with items..." << std::endl;
     Character archer(1, "Archer", 5);
-    archer.AddItem(Item(101, "Bow", "weapon", 15));
-    archer.AddItem(Item(102, "Arrow Pack", "ammo", 5));
+    archer.EmplaceItem(101, "Bow", "weapon", 15);
+    archer.EmplaceItem(102, "Arrow Pack", "ammo", 5);
 
     Character warrior(2, "Warrior", 8);
-    warrior.AddItem(Item(103, "Sword", "weapon", 25));
-    warrior.AddItem(Item(104, "Shield", "armor", 20));
-    warrior.AddItem(Item(105, "Health Potion", "consumable", 0));
+    warrior.EmplaceItem(103, "Sword", "weapon", 25);
+    warrior.EmplaceItem(104, "Shield", "armor", 20);
+    warrior.EmplaceItem(105, "Health Potion", "consumable", 0);
 
     Character mage(3, "Mage", 6);
-    mage.AddItem(Item(106, "Staff", "weapon", 18));
-    mage.AddItem(Item(107, "Mana Potion", "consumable", 0));
+    mage.EmplaceItem(106, "Staff", "weapon", 18);
+    mage.EmplaceItem(107, "Mana Potion", "consumable", 0);
 
-    repo.Add(archer);
-    repo.Add(warrior);
-    repo.Add(mage);
+    repo.Reserve(3);
+    repo.Add(std::move(archer));
+    repo.Add(std::move(warrior));
+    repo.Add(std::move(mage));
 
     std::cout << "Added 3 characters to repository." << std::endl << std::endl;
 
@@ -49,11 +57,14 @@ int main()
     std::cout << std::endl;
 
     std::cout << "3. Saving to JSON file..." << std::endl;
-    if (!repo.SaveToFile("characters.json"))
+    std::future<bool> pendingSave = repo.SaveToFileAsync("characters.json");
+    repo.Update(1, [](Character& character) { character.SetLevel(character.GetLevel() + 1); });
+    if (!pendingSave.get())
     {
         std::cerr << "Failed to save characters." << std::endl;
         return 1;
     }
+    std::cout << "Live Archer level is " << repo.GetById(1)->GetLevel() << ", the saved snapshot kept the old one." << std::endl;
     std::cout << std::endl;
 
     std::cout << "4. Clearing repository..." << std::endl;
@@ -76,7 +87,7 @@ int main()
     std::cout << std::endl;
 
     std::cout << "7. Finding character by ID (2)..." << std::endl;
-    Character* foundChar = repo.GetById(2);
+    const Character* foundChar = repo.GetById(2);
     if (foundChar)
     {
         std::cout << "Found: " << foundChar->GetName() << std::endl;
@@ -85,6 +96,83 @@ int main()
     {
         std::cout << "Character not found." << std::endl;
     }
+    std::cout << std::endl;
+
+    std::cout << "8. Building flat inventory arena..." << std::endl;
+    FlatCharacterRepository flatRepo = FlatCharacterRepository::FromRepository(repo);
+    for (const auto& character : flatRepo)
+    {
+        PrintCharacter(character);
+    }
+    std::cout << "Total weapon power: " << flatRepo.SumPowerByType("weapon") << std::endl;
+    std::cout << std::endl;
+
+    std::cout << "9. Querying inventories..." << std::endl;
+    PowerAggregate weapons = repo.Query().WhereType("weapon").WhereLevelBetween(6, 100).Aggregate();
+    std::cout << "Weapons of level 6+ characters: " << weapons.count
+              << " (sum " << weapons.sum << ", min " << weapons.min << ", max " << weapons.max << ")" << std::endl;
+
+    for (const auto& [type, group] : flatRepo.Query().GroupByType())
+    {
+        std::cout << "  " << type << ": " << group.count << " items, total power " << group.sum << std::endl;
+    }
+
+    for (const auto& match : flatRepo.Query().WherePowerBetween(1, 100).TopByPower(2))
+    {
+        std::cout << "  Top item " << match.itemId << " of character " << match.characterId
+                  << " (Power: " << match.power << ")" << std::endl;
+    }
+    std::cout << std::endl;
+
+    std::cout << "10. Opening file lazily..." << std::endl;
+    LazyCharacterRepository lazyRepo(2);
+    if (!lazyRepo.Open("characters.json"))
+    {
+        std::cerr << "Failed to index characters." << std::endl;
+        return 1;
+    }
+
+    for (int id : {3, 1, 3})
+    {
+        CachedCharacter lazyChar = lazyRepo.GetById(id);
+        if (lazyChar)
+        {
+            PrintCharacter(*lazyChar);
+        }
+    }
+    std::cout << "Hydrated " << lazyRepo.GetCachedCount() << " of " << lazyRepo.Size() << " characters." << std::endl;
+    std::cout << std::endl;
+
+    std::cout << "11. Updating characters from parallel sessions..." << std::endl;
+    ConcurrentCharacterRepository sharedRepo;
+    if (!sharedRepo.LoadFromFile("characters.json"))
+    {
+        std::cerr << "Failed to load characters." << std::endl;
+        return 1;
+    }
+
+    std::vector<std::thread> sessions;
+    for (int session = 0; session < 4; ++session)
+    {
+        sessions.emplace_back([&sharedRepo, session]()
+        {
+            for (int round = 0; round < 100; ++round)
+            {
+                sharedRepo.Update(session % 3 + 1, [](Character& c) { c.SetLevel(c.GetLevel() + 1); });
+            }
+        });
+    }
+
+    sharedRepo.SaveToFile("characters_shared.json");
+    for (auto& session : sessions)
+    {
+        session.join();
+    }
+
+    for (const auto& handle : sharedRepo.Snapshot())
+    {
+        std::cout << "  " << handle->GetName() << " level: " << handle->GetLevel() << std::endl;
+    }
 
     std::cout << "\nDemo Complete" << std::endl;
     return 0;